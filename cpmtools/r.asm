@@ -0,0 +1,156 @@
+;	Read a file from directory /HOST80 on the MicroSD into CP/M
+;
+;	Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+;
+;	R [d:]file.ext	copies /HOST80/file.ext to file.ext on drive d
+;	R		lists the files in /HOST80
+;
+	title	'Read a file from the MicroSD'
+
+	.8080
+	aseg
+	org	100h
+
+boot	equ	0		; warm boot
+bdos	equ	5		; BDOS entry
+fcb	equ	5ch		; default FCB
+dbuff	equ	80h		; default DMA buffer
+
+conout	equ	2		; BDOS functions
+print	equ	9
+close	equ	16
+delete	equ	19
+write	equ	21
+make	equ	22
+
+hfport	equ	9		; host file device
+hfaddr	equ	10h		; set address of command bytes
+hfopen	equ	20h		; open file 0 for reading
+hfread	equ	40h		; read record from file 0
+hfclose	equ	60h		; close file 0
+hffirst	equ	70h		; get first directory entry
+hfnext	equ	80h		; get next directory entry
+hfeof	equ	4		; status end of file or directory
+
+	lxi	sp,stack
+	mvi	a,hfaddr	; tell the device where the command bytes are
+	out	hfport
+	mvi	a,cmd and 0ffh
+	out	hfport
+	mvi	a,cmd shr 8
+	out	hfport
+	lda	fcb+1		; file name given?
+	cpi	' '
+	jz	dir		; no, list the files
+
+	lxi	h,fcb+1		; the file on the MicroSD has the same name
+	shld	cmd
+	mvi	a,hfopen
+	out	hfport
+	in	hfport
+	ora	a
+	lxi	d,nofile
+	jnz	error
+	lxi	d,fcb		; replace the CP/M file
+	mvi	c,delete
+	call	bdos
+	xra	a
+	sta	fcb+12
+	sta	fcb+14
+	sta	fcb+32
+	lxi	d,fcb
+	mvi	c,make
+	call	bdos
+	inr	a
+	lxi	d,dirful
+	jz	errcl
+	lxi	h,dbuff		; records go through the default DMA buffer
+	shld	cmd
+
+copy:	mvi	a,hfread	; read a record from the MicroSD
+	out	hfport
+	in	hfport
+	cpi	hfeof
+	jz	done
+	ora	a
+	lxi	d,rderr
+	jnz	errcl
+	lxi	d,fcb		; and write it into the CP/M file
+	mvi	c,write
+	call	bdos
+	ora	a
+	lxi	d,dskful
+	jnz	errcl
+	jmp	copy
+
+done:	lxi	d,fcb
+	mvi	c,close
+	call	bdos
+	inr	a
+	lxi	d,clserr
+	jz	errcl
+	mvi	a,hfclose
+	out	hfport
+	jmp	boot
+
+errcl:	mvi	a,hfclose	; close the file on the MicroSD
+	out	hfport
+error:	mvi	c,print		; print error message in DE
+	call	bdos
+	jmp	boot
+
+dir:	lxi	h,dbuff		; directory entries go into the DMA buffer
+	shld	cmd
+	mvi	a,hffirst
+	out	hfport
+	in	hfport
+	ora	a
+	lxi	d,nofile
+	jnz	error
+dirlp:	lxi	h,dbuff		; print name and extension
+	mvi	b,8
+	call	prtn
+	mvi	a,' '
+	call	prtc
+	mvi	b,3
+	call	prtn
+	lxi	d,crlf
+	mvi	c,print
+	call	bdos
+	mvi	a,hfnext
+	out	hfport
+	in	hfport
+	ora	a
+	jz	dirlp
+	jmp	boot
+
+prtn:	mov	a,m		; print B characters @ HL
+	call	prtc
+	inx	h
+	dcr	b
+	jnz	prtn
+	ret
+
+prtc:	push	b		; print character in A
+	push	h
+	mov	e,a
+	mvi	c,conout
+	call	bdos
+	pop	h
+	pop	b
+	ret
+
+nofile:	db	'No file',13,10,'$'
+dirful:	db	'Directory full',13,10,'$'
+rderr:	db	'Read error',13,10,'$'
+dskful:	db	'Disk full',13,10,'$'
+clserr:	db	'Can''t close file',13,10,'$'
+crlf:	db	13,10,'$'
+
+cmd:	dw	0		; DMA address
+	db	0		; bytes in the record
+
+	ds	32		; stack
+stack:
+
+	end
@@ -0,0 +1,100 @@
+;	Write a file from CP/M into directory /HOST80 on the MicroSD
+;
+;	Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+;
+;	W [d:]file.ext	copies file.ext on drive d to /HOST80/file.ext
+;
+	title	'Write a file to the MicroSD'
+
+	.8080
+	aseg
+	org	100h
+
+boot	equ	0		; warm boot
+bdos	equ	5		; BDOS entry
+fcb	equ	5ch		; default FCB
+dbuff	equ	80h		; default DMA buffer
+
+print	equ	9		; BDOS functions
+open	equ	15
+read	equ	20
+
+hfport	equ	9		; host file device
+hfaddr	equ	10h		; set address of command bytes
+hfcreat	equ	30h		; create file 0 for writing
+hfwrite	equ	50h		; write record to file 0
+hfclose	equ	60h		; close file 0
+
+	lxi	sp,stack
+	mvi	a,hfaddr	; tell the device where the command bytes are
+	out	hfport
+	mvi	a,cmd and 0ffh
+	out	hfport
+	mvi	a,cmd shr 8
+	out	hfport
+	lda	fcb+1		; file name given?
+	cpi	' '
+	lxi	d,usage
+	jz	error
+
+	xra	a		; open the CP/M file
+	sta	fcb+12
+	sta	fcb+32
+	lxi	d,fcb
+	mvi	c,open
+	call	bdos
+	inr	a
+	lxi	d,nofile
+	jz	error
+	lxi	h,fcb+1		; the file on the MicroSD gets the same name
+	shld	cmd
+	mvi	a,hfcreat
+	out	hfport
+	in	hfport
+	ora	a
+	lxi	d,crerr
+	jnz	error
+	lxi	h,dbuff		; whole records go through the DMA buffer
+	shld	cmd
+	xra	a
+	sta	cmd+2
+
+copy:	lxi	d,fcb		; read a record from the CP/M file
+	mvi	c,read
+	call	bdos
+	ora	a
+	jnz	done
+	mvi	a,hfwrite	; and write it to the MicroSD
+	out	hfport
+	in	hfport
+	ora	a
+	jz	copy
+	lxi	d,wrerr
+	mvi	a,hfclose
+	out	hfport
+	jmp	error
+
+done:	mvi	a,hfclose
+	out	hfport
+	in	hfport
+	ora	a
+	lxi	d,wrerr
+	jnz	error
+	jmp	boot
+
+error:	mvi	c,print		; print error message in DE
+	call	bdos
+	jmp	boot
+
+usage:	db	'Usage: W [d:]file.ext',13,10,'$'
+nofile:	db	'No file',13,10,'$'
+crerr:	db	'Can''t create file',13,10,'$'
+wrerr:	db	'Write error',13,10,'$'
+
+cmd:	dw	0		; DMA address
+	db	0		; bytes in the record, 0 = 128
+
+	ds	32		; stack
+stack:
+
+	end
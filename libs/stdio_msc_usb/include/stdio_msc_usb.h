@@ -133,6 +133,14 @@
 #define STDIO_MSC_USB_SUPPORT_CHARS_AVAILABLE_CALLBACK 1
 #endif
 
+// PICO_CONFIG: STDIO_MSC_USB_AUX_CDC, Add a second CDC interface for use by the application, which isn't used for stdio, type=bool, default=0, group=stdio_msc_usb
+#ifndef STDIO_MSC_USB_AUX_CDC
+#define STDIO_MSC_USB_AUX_CDC 0
+#endif
+#if STDIO_MSC_USB_AUX_CDC && STDIO_MSC_USB_DISABLE_STDIO
+#error STDIO_MSC_USB_AUX_CDC needs the stdio CDC interface
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -164,6 +172,45 @@ bool stdio_msc_usb_deinit(void);
  */
 bool stdio_msc_usb_connected(void);
 
+/*! \brief Write chars to the CDC interface without waiting, also from interrupt handlers
+ *  \ingroup stdio_msc_usb
+ *
+ *  \return the number of chars written, 0 if the USB stack is busy or the CDC FIFO is full.
+ *  If there is no CDC connection, all chars are discarded and length is returned
+ */
+int stdio_msc_usb_out_chars_try(const char *buf, int length);
+
+/*! \brief Read chars from the CDC interface without waiting, also from interrupt handlers
+ *  \ingroup stdio_msc_usb
+ *
+ *  \return the number of chars read, 0 if the USB stack is busy or there is no input
+ */
+int stdio_msc_usb_in_chars_try(char *buf, int length);
+
+#if STDIO_MSC_USB_AUX_CDC
+/*! \brief Check if there is a connection to the second CDC interface
+ *  \ingroup stdio_msc_usb
+ *
+ *  \return true if the host set DTR on the second CDC interface
+ */
+bool stdio_msc_usb_aux_connected(void);
+
+/*! \brief Read chars from the second CDC interface without waiting, also from interrupt handlers
+ *  \ingroup stdio_msc_usb
+ *
+ *  \return the number of chars read, 0 if the USB stack is busy or there is no input
+ */
+int stdio_msc_usb_aux_in_chars_try(char *buf, int length);
+
+/*! \brief Write chars to the second CDC interface without waiting, also from interrupt handlers
+ *  \ingroup stdio_msc_usb
+ *
+ *  \return the number of chars written, 0 if the USB stack is busy or the CDC FIFO is full.
+ *  If there is no connection, all chars are discarded and length is returned
+ */
+int stdio_msc_usb_aux_out_chars_try(const char *buf, int length);
+#endif
+
 void stdio_msc_usb_enable_irq_tud_task(void);
 
 void stdio_msc_usb_disable_irq_tud_task(void);
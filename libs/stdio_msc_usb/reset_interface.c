@@ -24,8 +24,10 @@ static uint8_t itf_num;
 #define BOS_TOTAL_LEN      (TUD_BOS_DESC_LEN + TUD_BOS_MICROSOFT_OS_DESC_LEN)
 
 #define MS_OS_20_DESC_LEN  166
-#ifdef STDIO_MSC_USB_DISABLE_STDIO
+#if STDIO_MSC_USB_DISABLE_STDIO
 #define USBD_ITF_RPI_RESET 1
+#elif STDIO_MSC_USB_AUX_CDC
+#define USBD_ITF_RPI_RESET 5
 #else
 #define USBD_ITF_RPI_RESET 3
 #endif
@@ -176,8 +178,9 @@ usbd_class_driver_t const *usbd_app_driver_get_cb(uint8_t *driver_count) {
 
 #if STDIO_MSC_USB_ENABLE_RESET_VIA_BAUD_RATE
 // Support for default BOOTSEL reset by changing baud rate
-void tud_cdc_line_coding_cb(__unused uint8_t itf, cdc_line_coding_t const* p_line_coding) {
-    if (p_line_coding->bit_rate == STDIO_MSC_USB_RESET_MAGIC_BAUD_RATE) {
+void tud_cdc_line_coding_cb(uint8_t itf, cdc_line_coding_t const* p_line_coding) {
+    // only the stdio interface, the second one may really use that baud rate
+    if (itf == 0 && p_line_coding->bit_rate == STDIO_MSC_USB_RESET_MAGIC_BAUD_RATE) {
 #ifdef STDIO_MSC_USB_RESET_BOOTSEL_ACTIVITY_LED
         int gpio = STDIO_MSC_USB_RESET_BOOTSEL_ACTIVITY_LED;
         bool active_low = STDIO_MSC_USB_RESET_BOOTSEL_ACTIVITY_LED_ACTIVE_LOW;
@@ -150,6 +150,80 @@ static void stdio_msc_usb_out_flush(void) {
     mutex_exit(&stdio_msc_usb_mutex);
 }
 
+// non-blocking output, which can also be used in interrupt handlers. writes as many chars
+// as fit into the CDC FIFO and returns their number, which is 0 if the USB stack is in
+// use by other code at the moment. if not connected, the chars are discarded.
+int stdio_msc_usb_out_chars_try(const char *buf, int length) {
+    int n = length;
+    if (!mutex_try_enter(&stdio_msc_usb_mutex, NULL)) {
+        return 0;
+    }
+    if (stdio_msc_usb_connected()) {
+        uint32_t avail = tud_cdc_write_available();
+        if ((uint32_t) n > avail) n = (int) avail;
+        if (n) {
+            n = (int) tud_cdc_write(buf, (uint32_t) n);
+            tud_cdc_write_flush();
+        }
+    }
+    mutex_exit(&stdio_msc_usb_mutex);
+    return n;
+}
+
+// non-blocking input, which can also be used in interrupt handlers. reads the chars
+// waiting in the CDC FIFO and returns their number, which is 0 if there is no input
+// or the USB stack is in use by other code at the moment.
+int stdio_msc_usb_in_chars_try(char *buf, int length) {
+    int n = 0;
+    if (!mutex_try_enter(&stdio_msc_usb_mutex, NULL)) {
+        return 0;
+    }
+    if (stdio_msc_usb_connected() && tud_cdc_available()) {
+        n = (int) tud_cdc_read(buf, (uint32_t) length);
+    }
+    mutex_exit(&stdio_msc_usb_mutex);
+    return n;
+}
+
+#if STDIO_MSC_USB_AUX_CDC
+// the second CDC interface is instance 1 of the CDC class, the functions for it don't
+// wait and can also be used in interrupt handlers
+#define AUX_CDC 1
+
+bool stdio_msc_usb_aux_connected(void) {
+    return tud_cdc_n_connected(AUX_CDC);
+}
+
+int stdio_msc_usb_aux_in_chars_try(char *buf, int length) {
+    int n = 0;
+    if (!mutex_try_enter(&stdio_msc_usb_mutex, NULL)) {
+        return 0;
+    }
+    if (tud_cdc_n_available(AUX_CDC)) {
+        n = (int) tud_cdc_n_read(AUX_CDC, buf, (uint32_t) length);
+    }
+    mutex_exit(&stdio_msc_usb_mutex);
+    return n;
+}
+
+int stdio_msc_usb_aux_out_chars_try(const char *buf, int length) {
+    int n = length;
+    if (!mutex_try_enter(&stdio_msc_usb_mutex, NULL)) {
+        return 0;
+    }
+    if (tud_cdc_n_connected(AUX_CDC)) {
+        uint32_t avail = tud_cdc_n_write_available(AUX_CDC);
+        if ((uint32_t) n > avail) n = (int) avail;
+        if (n) {
+            n = (int) tud_cdc_n_write(AUX_CDC, buf, (uint32_t) n);
+            tud_cdc_n_write_flush(AUX_CDC);
+        }
+    }
+    mutex_exit(&stdio_msc_usb_mutex);
+    return n;
+}
+#endif
+
 int stdio_msc_usb_in_chars(char *buf, int length) {
     // note we perform this check outside the lock, to try and prevent possible deadlock conditions
     // with printf in IRQs (which we will escape through timeouts elsewhere, but that would be less graceful).
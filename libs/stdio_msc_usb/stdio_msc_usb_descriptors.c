@@ -60,9 +60,9 @@
 #endif
 #else
 #if !STDIO_MSC_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE
-#define USBD_DESC_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN)
+#define USBD_DESC_LEN (TUD_CONFIG_DESC_LEN + CFG_TUD_CDC * TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN)
 #else
-#define USBD_DESC_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN + TUD_RPI_RESET_DESC_LEN)
+#define USBD_DESC_LEN (TUD_CONFIG_DESC_LEN + CFG_TUD_CDC * TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN + TUD_RPI_RESET_DESC_LEN)
 #endif
 #endif
 #if !STDIO_MSC_USB_DEVICE_SELF_POWERED
@@ -87,7 +87,7 @@
 
 #define USBD_STR_MSC (0x04)
 #define USBD_STR_RPI_RESET (0x05)
-#else
+#elif !STDIO_MSC_USB_AUX_CDC
 #define USBD_ITF_CDC       (0) // needs 2 interfaces
 #define USBD_ITF_MSC       (2)
 #if !STDIO_MSC_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE
@@ -107,6 +107,32 @@
 #define USBD_STR_CDC (0x04)
 #define USBD_STR_MSC (0x05)
 #define USBD_STR_RPI_RESET (0x06)
+#else
+#define USBD_ITF_CDC       (0) // needs 2 interfaces
+#define USBD_ITF_CDC_AUX   (2) // needs 2 interfaces
+#define USBD_ITF_MSC       (4)
+#if !STDIO_MSC_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE
+#define USBD_ITF_MAX       (5)
+#else
+#define USBD_ITF_RPI_RESET (5)
+#define USBD_ITF_MAX       (6)
+#endif
+
+#define USBD_CDC_EP_CMD (0x81)
+#define USBD_CDC_EP_OUT (0x02)
+#define USBD_CDC_EP_IN (0x82)
+
+#define USBD_MSC_EP_OUT (0x03)
+#define USBD_MSC_EP_IN (0x83)
+
+#define USBD_CDC_AUX_EP_CMD (0x84)
+#define USBD_CDC_AUX_EP_OUT (0x05)
+#define USBD_CDC_AUX_EP_IN (0x85)
+
+#define USBD_STR_CDC (0x04)
+#define USBD_STR_MSC (0x05)
+#define USBD_STR_RPI_RESET (0x06)
+#define USBD_STR_CDC_AUX (0x07)
 #endif
 
 #define USBD_CDC_CMD_MAX_SIZE (8)
@@ -159,6 +185,11 @@ static const uint8_t usbd_desc_cfg[USBD_DESC_LEN] = {
         USBD_CDC_CMD_MAX_SIZE, USBD_CDC_EP_OUT, USBD_CDC_EP_IN, USBD_CDC_IN_OUT_MAX_SIZE),
 #endif
 
+#if STDIO_MSC_USB_AUX_CDC
+    TUD_CDC_DESCRIPTOR(USBD_ITF_CDC_AUX, USBD_STR_CDC_AUX, USBD_CDC_AUX_EP_CMD,
+        USBD_CDC_CMD_MAX_SIZE, USBD_CDC_AUX_EP_OUT, USBD_CDC_AUX_EP_IN, USBD_CDC_IN_OUT_MAX_SIZE),
+#endif
+
     TUD_MSC_DESCRIPTOR(USBD_ITF_MSC, USBD_STR_MSC, USBD_MSC_EP_OUT,
         USBD_MSC_EP_IN, USBD_MSC_IN_OUT_MAX_SIZE),
 
@@ -180,6 +211,9 @@ static const char *const usbd_desc_str[] = {
 #if STDIO_MSC_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE
     [USBD_STR_RPI_RESET] = "Reset",
 #endif
+#if STDIO_MSC_USB_AUX_CDC
+    [USBD_STR_CDC_AUX] = "Board CDC 2",
+#endif
 };
 
 const uint8_t *tud_descriptor_device_cb(void) {
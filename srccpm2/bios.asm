@@ -19,6 +19,7 @@ DDTRK	EQU	0		;offset for track
 DDSEC	EQU	1		;offset for sector
 DDLDMA	EQU	2		;offset for DMA address low
 DDHDMA	EQU	3		;offset for DMA address high
+DDCNT	EQU	4		;offset for sector count
 ;
 ;	I/O ports
 ;
@@ -75,6 +76,11 @@ DPBASE	DW	TRANS,0000H
 	DW	0000H,0000H
 	DW	DIRBF,DPBLK
 	DW	CHK03,ALL03
+;	disk parameter header for disk 4, RAM disk on RP2350
+	DW	TRANS,0000H
+	DW	0000H,0000H
+	DW	DIRBF,DPBLK
+	DW	CHK04,ALL04
 ;
 ;	sector translate table for IBM 8" SD disks
 TRANS	DB	1,7,13,19	;sectors 1,2,3,4
@@ -123,6 +129,16 @@ BOOT	LXI	SP,80H		;use space below buffer for stack
 	OUT	FDC
 	MVI	A,FDCCMD SHR 8
 	OUT	FDC
+	XRA	A		;only the RP2350 has a RAM disk, try
+	STA	FDCCMD+DDTRK	;to read track 0 sector 1 from drive 4
+	INR	A
+	STA	FDCCMD+DDSEC
+	LXI	H,DIRBF		;into the scratch directory area
+	SHLD	FDCCMD+DDLDMA
+	MVI	A,24H		;read sector from drive 4
+	OUT	FDC
+	IN	FDC		;get status from FDC
+	STA	RDISK		;zero if the RAM disk is available
 	STC			;flag for cold start
 	CMC
 	JMP	GOCPM		;initialize and go to CP/M
@@ -133,40 +149,21 @@ WBOOT	LXI	SP,80H		;use space below buffer for stack
 	MVI	C,0		;select disk 0
 	CALL	SELDSK
 	CALL	HOME		;go to track 0
-	MVI	B,NSECTS	;B counts # of sectors to load
-	MVI	C,0		;C has the current track #
-	MVI	D,2		;D has the next sector to load
+	MVI	A,2		;begin with sector 2
+	STA	FDCCMD+DDSEC
 	LXI	H,CCP		;base of CP/M
-LOAD1	PUSH	B		;save sector count and current track
-	PUSH	D		;save next sector to read
-	PUSH	H		;save DMA address
-	MOV	C,D		;get sector address to C
-	CALL	SETSEC		;set sector address
-	POP	B		;recall DMA address to BC
-	PUSH	B		;and replace on stack for later recall
-	CALL	SETDMA		;set DMA address from BC
-	CALL	READ		;read sector
+	SHLD	FDCCMD+DDLDMA	;is the DMA address
+	MVI	A,NSECTS	;# of sectors to load
+	STA	FDCCMD+DDCNT
+	MVI	A,30H		;read all sectors from drive 0 in one go
+	OUT	FDC
+	IN	FDC		;get status from FDC
 	ORA	A		;any errors?
-	JZ	LOAD2		;no, continue
+	JZ	LOAD1		;no, continue
 	LXI	H,BOOTERR	;otherwise print message
 	CALL	PRTMSG
 	HLT			;and halt the machine
-LOAD2	POP	H		;recall DMA address
-	LXI	D,128		;DMA = DMA + 128
-	DAD	D		;next DMA address now in HL
-	POP	D		;recall sector address
-	POP	B		;recall # of sectors remaining
-	DCR	B		;sectors = sectors - 1
-	STC			;flag for warm start
-	JZ	GOCPM		;transfer to CP/M if all loaded
-	INR	D		;next sector
-	MOV	A,D		;sector = 27 ?
-	CPI	27
-	JC	LOAD1		;no, continue
-	MVI	D,1		;else begin with sector 1 on next track
-	INR	C
-	CALL	SETTRK
-	JMP	LOAD1		;for another sector
+LOAD1	STC			;flag for warm start
 GOCPM	MVI	A,0C3H		;C3 is a JMP instruction
 	STA	0		;for jmp to wboot
 	LXI	H,WBE		;WBOOT entry point
@@ -237,7 +234,11 @@ SELDSK	LXI	H,0		;error return code
 	MOV	A,C		;get disk # to accumulator
 	CPI	4		;disk drive < 4 ?
 	JC	SEL1
-	RET			;no, return with error
+	RNZ			;no RAM disk, return with error
+	LDA	RDISK		;RAM disk available?
+	ORA	A
+	RNZ			;no, return with error
+	MOV	A,C		;get disk # to accumulator again
 SEL1	STA	DSKNO		;save disk #
 	MOV	L,C		;HL = disk #
 	DAD	H		;*2
@@ -311,16 +312,19 @@ SECTRAN	XCHG			;HL=.TRANS
 BEGDAT	EQU	$		;begin of data area
 ;
 DSKNO	DS	1		;selected disk
+RDISK	DS	1		;FDC status of RAM disk, 0 = available
 ;
 DIRBF	DS	128		;scratch directory area
 ALL00	DS	31		;allocation vector 0
 ALL01	DS	31		;allocation vector 1
 ALL02	DS	31		;allocation vector 2
 ALL03	DS	31		;allocation vector 3
+ALL04	DS	31		;allocation vector 4
 CHK00	DS	16		;check vector 0
 CHK01	DS	16		;check vector 1
 CHK02	DS	16		;check vector 2
 CHK03	DS	16		;check vector 3
+CHK04	DS	16		;check vector 4
 ;
 ENDDAT	EQU	$		;end of data area
 DATSIZ	EQU	$-BEGDAT	;size of data area
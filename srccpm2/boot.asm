@@ -25,41 +25,18 @@ FDC	EQU	4		;FDC port
 	OUT	FDC
 	MVI	A,CMD SHR 8
 	OUT	FDC
-	LXI	B,2		;B=track 0, C=sector 2
-	MVI	D,SECTS		;D=# sectors to load
-;
-; load the next sector
-;
-LSECT	MVI	A,20H		;tell FDC to read sector on drive 0
+	MVI	A,30H		;tell FDC to read SECTS sectors on drive 0
 	OUT	FDC
 	IN	FDC		;get result from FDC
 	ORA	A
-	JZ	BOOT1
-	HLT			;read error, halt CPU
-BOOT1	DCR	D		;SECTS=SECTS-1
 	JZ	BOOTE		;go to CP/M if all sectors done
-	INR	C		;sector = sector + 1
-	MOV	A,C
-	CPI	27		;last sector of track?
-	JC	BOOT2		;no, do next sector
-	MVI	C,1		;sector = 1
-	INR	B		;track = track + 1
-BOOT2	MOV	A,B		;setup command
-	STA	CMD+0		;save track
-	MOV	A,C
-	STA	CMD+1		;save sector
-	PUSH	D
-	LHLD	CMD+2		;get DMA address
-	LXI	D,80H		;and increase it by 128
-	DAD	D
-	POP	D
-	SHLD	CMD+2		;set new dma address
-	JMP	LSECT		;for next sector
+	HLT			;read error, halt CPU
 ;
 ; command bytes for the FDC
 CMD	DB	00H		;track 0
 	DB	02H		;sector 2
 	DB	CPMB AND 0FFH	;DMA address low
 	DB	CPMB SHR 8	;DMA address high
+	DB	SECTS		;# of sectors to load
 
 	END			;of boot loader
@@ -8,6 +8,10 @@
 ; 07-JUL-2024 added RTC
 ; 14-JUL-2024 fixed bug, FCB one byte short
 ; 23-JUL-2024 fixed status bug in READ/WRITE found by Thomas
+; 16-OCT-2026 added hard disks I: and J: with 512 byte sectors
+; 16-OCT-2026 added RAM disk E: for RP2350
+; 16-OCT-2026 MOVE/XMOVE with the memory DMA controller
+; 16-OCT-2026 select RAM disk E: only if the FDC has one
 ;
 WARM	EQU	0		; BIOS warm start
 BDOS	EQU	5		; BDOS entry
@@ -48,9 +52,11 @@ TPA	EQU	0100H		; start of TPA
 TTY1	EQU	01H		; tty 1 data
 TTY1S	EQU	00H		; tty 1 status
 FDC	EQU	04H		; FDC
+HDC	EQU	08H		; HDC
 MMUSEL	EQU	40H		; MMU bank select
 CLKCMD	EQU	41H		; RTC command
 CLKDAT	EQU	42H		; RTC data
+MDMA	EQU	44H		; memory DMA controller
 LEDS	EQU	0FFH		; frontpanel LED's
 ;
 ;	external references in SCB
@@ -103,12 +109,12 @@ DRIVES:	DW	DPH0
 	DW	DPH1
 	DW	DPH2
 	DW	DPH3
+	DW	DPH4
 	DW	0
 	DW	0
 	DW	0
-	DW	0
-	DW	0
-	DW	0
+	DW	DPH8
+	DW	DPH9
 	DW	0
 	DW	0
 	DW	0
@@ -163,6 +169,46 @@ DPH3:	DW	TRANS		; sector translate table
 	DW	0FFFFH		; hashing not used
 	DB	0		; hash bank
 ;
+;	disk parameter header for the RAM disk on RP2350,
+;	same format as the 8" SD disks
+;
+DPH4:	DW	TRANS		; sector translate table
+	DB	0,0,0,0		; BDOS scratch area
+	DB	0,0,0,0,0
+	DB	0		; media flag
+	DW	DPBFD		; disk parameter block
+	DW	0FFFEH		; checksum vector
+	DW	0FFFEH		; allocation vector
+	DW	0FFFEH		; directory buffer control block
+	DW	0FFFFH		; DTABCB not used
+	DW	0FFFFH		; hashing not used
+	DB	0		; hash bank
+;
+;	disk parameter headers for the hard disks
+;
+DPH8:	DW	0		; no sector translation
+	DB	0,0,0,0		; BDOS scratch area
+	DB	0,0,0,0,0
+	DB	0		; media flag
+	DW	DPBHD8		; disk parameter block
+	DW	0FFFEH		; checksum vector
+	DW	0FFFEH		; allocation vector
+	DW	0FFFEH		; directory buffer control block
+	DW	0FFFEH		; data buffer control block
+	DW	0FFFFH		; hashing not used
+	DB	0		; hash bank
+DPH9:	DW	0		; no sector translation
+	DB	0,0,0,0		; BDOS scratch area
+	DB	0,0,0,0,0
+	DB	0		; media flag
+	DW	DPBHD9		; disk parameter block
+	DW	0FFFEH		; checksum vector
+	DW	0FFFEH		; allocation vector
+	DW	0FFFEH		; directory buffer control block
+	DW	0FFFEH		; data buffer control block
+	DW	0FFFFH		; hashing not used
+	DB	0		; hash bank
+;
 ;	sector translate table for IBM 3740 8" SD disk
 ;
 TRANS:	DB	1,7,13,19	; sectors 1,2,3,4
@@ -187,13 +233,41 @@ DPBFD:	DW	26		; sectors per track
 	DW	2		; track offset
 	DB	0,0		; physical sector size and shift
 ;
-;	FDC command bytes
+;	disk parameter blocks for the hard disks, 32 sectors of
+;	512 bytes per track and up to 512 tracks, the disk size
+;	is adjusted to the image size when the disk is logged in
+;
+DPBHD8:	DW	128		; 128 byte records per track
+	DB	5		; block shift factor
+	DB	31		; block mask
+	DB	1		; extend mask
+	DW	2047		; disk size - 1
+	DW	1023		; directory max
+	DB	255		; alloc 0
+	DB	0		; alloc 1
+	DW	8000H		; check size, permanent disk
+	DW	0		; track offset
+	DB	2,3		; physical sector size and shift
+DPBHD9:	DW	128		; 128 byte records per track
+	DB	5		; block shift factor
+	DB	31		; block mask
+	DB	1		; extend mask
+	DW	2047		; disk size - 1
+	DW	1023		; directory max
+	DB	255		; alloc 0
+	DB	0		; alloc 1
+	DW	8000H		; check size, permanent disk
+	DW	0		; track offset
+	DB	2,3		; physical sector size and shift
 ;
-CMD:	DS	4
+;	FDC and HDC command bytes
+;
+CMD:	DS	5
 DDTRK	EQU	CMD+0		; track
 DDSEC	EQU	CMD+1		; sector
 DDLDMA	EQU	CMD+2		; DMA address low
 DDHDMA	EQU	CMD+3		; DMA address high
+DDTRKH	EQU	CMD+4		; track high, HDC only
 ;
 ;	character device table
 ;
@@ -216,7 +290,10 @@ OPNERR:	DB	'Open error CCP.COM',13,10,'$'
 RDRERR:	DB	'Read error CCP.COM',13,10,'$'
 ;
 BANK:	DB	0		; bank to select for DMA
+XSRC:	DB	0FFH		; source bank for MOVE, 0FFH = selected
+XDST:	DB	0FFH		; destination bank for MOVE, 0FFH = selected
 SDISK:	DB	0		; selected disk
+RDISK:	DB	0FFH		; FDC status of RAM disk, 0 = available
 ;
 	DS	32		; small stack
 STACK:
@@ -224,7 +301,7 @@ STACK:
 	DSEG
 ;
 SIGNON:	DB	13,10
-	DB	'Banked BIOS V1.3',13,10
+	DB	'Banked BIOS V1.4',13,10
 	DB	'Copyright (C) 2024 Udo Munk',13,10,13,10
 	DB	0
 ;
@@ -248,6 +325,30 @@ BOOT:	LXI	SP,STACK
 	OUT	FDC
 	MOV	A,H
 	OUT	FDC
+	MVI	A,10H		; setup HDC command
+	OUT	HDC
+	LXI	H,CMD
+	MOV	A,L
+	OUT	HDC
+	MOV	A,H
+	OUT	HDC
+;
+;	only the RP2350 has a RAM disk, find out if the FDC
+;	can read a sector from drive 4
+;
+	XRA	A		; track 0
+	STA	DDTRK
+	INR	A		; sector 1
+	STA	DDSEC
+	LXI	H,TPA-128	; DMA to default buffer, not used yet
+	MOV	A,L
+	STA	DDLDMA
+	MOV	A,H
+	STA	DDHDMA
+	MVI	A,24H		; read sector from drive 4
+	OUT	FDC		; ask FDC to execute the command
+	IN	FDC		; get FDC status
+	STA	RDISK		; and save it
 ;
 	LXI	H,SIGNON	; print signon
 BOOT1:	MOV	A,M		; get next message bye
@@ -444,6 +545,12 @@ SELDSK: LXI	H,0		; HL = error return code
 	JZ	SEL2		; select disk 2
 	CPI	3		; disk 3 ?
 	JZ	SEL3		; select disk 3
+	CPI	4		; RAM disk ?
+	JZ	SEL4		; select RAM disk
+	CPI	8		; hard disk I: ?
+	JZ	SEL8		; select hard disk I:
+	CPI	9		; hard disk J: ?
+	JZ	SEL9		; select hard disk J:
 	RET			; else return with error
 SEL0:	STA	SDISK
 	LXI	H,DPH0		; HL = disk parameter header disk 0
@@ -457,11 +564,60 @@ SEL2:	STA	SDISK
 SEL3:	STA	SDISK
 	LXI	H,DPH3		; HL = disk parameter header disk 3
 	RET
+SEL4:	LDA	RDISK		; RAM disk available ?
+	ORA	A
+	RNZ			; no, return with error
+	MVI	A,4
+	STA	SDISK
+	LXI	H,DPH4		; HL = disk parameter header RAM disk
+	RET
+SEL8:	STA	SDISK
+	MOV	A,E		; get login flag
+	LXI	H,DPH8		; HL = disk parameter header hard disk I:
+	LXI	D,DPBHD8+5	; DE = disk size in parameter block
+	JMP	SELHD
+SEL9:	STA	SDISK
+	MOV	A,E		; get login flag
+	LXI	H,DPH9		; HL = disk parameter header hard disk J:
+	LXI	D,DPBHD9+5	; DE = disk size in parameter block
+;
+;	on the first select of a hard disk get the number of
+;	tracks from the HDC and adjust the disk size to it,
+;	4 blocks per track
+;
+SELHD:	RAR			; disk logged in before ?
+	RC			; yes, done
+	PUSH	H		; save DPH
+	LDA	SDISK		; get HDC drive
+	SUI	8
+	ORI	30H		; mask in get tracks command
+	OUT	HDC		; ask HDC to execute the command
+	IN	HDC		; get HDC status
+	ORA	A		; is it zero ?
+	JNZ	SELERR		; no, select error
+	LDA	DDTRK		; HL = number of tracks
+	MOV	L,A
+	LDA	DDTRKH
+	MOV	H,A
+	DAD	H		; * 4
+	DAD	H
+	DCX	H		; - 1
+	XCHG
+	MOV	M,E		; = disk size - 1
+	INX	H
+	MOV	M,D
+	POP	H		; return DPH
+	RET
+SELERR:	POP	H		; discard DPH
+	LXI	H,0		; return with error
+	RET
 ;
 ;	set track given by register C
 ;
 SETTRK:	MOV	A,C		; get track to A
 	STA	DDTRK		; and set in FDC command bytes
+	MOV	A,B		; get high track to A
+	STA	DDTRKH		; and set in HDC command bytes
 	RET
 ;
 ;	set sector given by register C
@@ -502,31 +658,32 @@ SETDMA:	MOV	A,C		; low order address
 ;
 ;	perform read operation
 ;
-READ:	LDA	BANK		; switch to saved bank
-	OUT	MMUSEL
-	LDA	SDISK		; get disk
-	ORI	20H		; mask in read command
-	OUT	FDC		; ask FDC to execute the command
-	XRA	A		; reselect bank 0
-	OUT	MMUSEL
-	IN	FDC		; get FDC status
-	ORA	A		; is it zero ?
-	RZ			; return if OK
-	CMA			; complement for LED's
-	OUT	LEDS		; display the error code
-	MVI	A,1		; nonrecoverable error
-	RET			; return with error
+READ:	MVI	B,20H		; read command
+	JMP	DSKIO
 ;
 ;	perform write operation
 ;
-WRITE:	LDA	BANK		; switch to saved bank
+WRITE:	MVI	B,40H		; write command
+;
+;	execute the command in B with FDC or HDC
+;
+DSKIO:	LDA	BANK		; switch to saved bank
 	OUT	MMUSEL
 	LDA	SDISK		; get disk
-	ORI	40H		; mask in write command
+	CPI	8		; hard disk ?
+	JNC	DSKIO1		; yes
+	ORA	B		; mask in command
 	OUT	FDC		; ask FDC to execute the command
+	IN	FDC		; get FDC status
+	JMP	DSKIO2
+DSKIO1:	SUI	8		; get HDC drive
+	ORA	B		; mask in command
+	OUT	HDC		; ask HDC to execute the command
+	IN	HDC		; get HDC status
+DSKIO2:	MOV	B,A		; save status
 	XRA	A		; reselect bank 0
 	OUT	MMUSEL
-	IN	FDC		; get FDC status
+	MOV	A,B		; get status back
 	ORA	A		; is it zero ?
 	RZ			; return if OK
 	CMA			; complement for LED's
@@ -545,19 +702,36 @@ MULTIO:	XRA	A		; do nothing
 FLUSH:	XRA	A		; no user deblocking
 	RET
 ;
-;	memory to memory block move
+;	memory to memory block move with the memory DMA controller
 ;	HL = destination address
 ;	DE = source address
 ;	BC = count
-;
-MOVE:	LDAX	D
-	MOV	M,A
-	INX	D
-	INX	H
-	DCX	B
+;	returns HL and DE pointing to the bytes following the move
+;
+MOVE:	IN	MDMA		; reset DMA command sequence
+	LDA	XSRC		; source bank
+	OUT	MDMA
+	MOV	A,E		; source address
+	OUT	MDMA
+	MOV	A,D
+	OUT	MDMA
+	LDA	XDST		; destination bank
+	OUT	MDMA
+	MOV	A,L		; destination address
+	OUT	MDMA
+	MOV	A,H
+	OUT	MDMA
+	MOV	A,C		; count, starts the move
+	OUT	MDMA
 	MOV	A,B
-	ORA	C
-	JNZ	MOVE
+	OUT	MDMA
+	DAD	B		; advance destination
+	XCHG
+	DAD	B		; advance source
+	XCHG
+	MVI	A,0FFH		; next MOVE in selected bank again
+	STA	XSRC
+	STA	XDST
 	RET
 ;
 ;	select memory bank
@@ -571,8 +745,14 @@ SETBNK:	STA	BANK
 	RET
 ;
 ;	set banks for following MOVE
+;	B = destination bank
+;	C = source bank
 ;
-XMOVE: RET			; no memory to memory DMA available
+XMOVE:	MOV	A,C
+	STA	XSRC
+	MOV	A,B
+	STA	XDST
+	RET
 ;
 ;	get/set time
 ;
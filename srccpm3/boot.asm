@@ -5,6 +5,7 @@
 ;
 ; History:
 ; 30-JUN-2024 first public release
+; 16-OCT-2026 load cpmldr with one multi sector FDC command
 ;
 	ORG	0		; memory base of boot
 ;
@@ -23,34 +24,18 @@ FDC	EQU	4		;FDC port
 	OUT	FDC
 	MVI	A,CMD SHR 8
 	OUT	FDC
-	LXI	B,2		;B=track 0, C=sector 2
-	MVI	D,SECTS		;D=# sectors to load
-;
-; load the next sector
-;
-LSECT	MVI	A,20H		;tell FDC to read sector on drive 0
+	MVI	A,30H		;tell FDC to read SECTS sectors on drive 0
 	OUT	FDC
 	IN	FDC		;get result from FDC
 	ORA	A
-	JZ	BOOT1
-	HLT			;read error, halt CPU
-BOOT1	DCR	D		;SECTS=SECTS-1
 	JZ	BOOT		;all done, head for cpmldr
-	INR	C		;sector = sector + 1
-	MOV	A,C
-	STA	CMD+1		;save sector
-	PUSH	D
-	LHLD	CMD+2		;get DMA address
-	LXI	D,80H		;and increase it by 128
-	DAD	D
-	POP	D
-	SHLD	CMD+2		;set new dma address
-	JMP	LSECT		;for next sector
+	HLT			;read error, halt CPU
 ;
 ; command bytes for the FDC
 CMD	DB	00H		;track 0
 	DB	02H		;sector 2
 	DB	BOOT AND 0FFH	;DMA address low
 	DB	BOOT SHR 8	;DMA address high
+	DB	SECTS		;# of sectors to load
 
 	END			;of boot loader
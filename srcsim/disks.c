@@ -11,17 +11,35 @@
  * 28-MAY-2024 implemented sector I/O to disk images
  * 03-JUN-2024 added directory list for code files and disk images
  * 29-JUN-2024 split of from memsim.c and picosim.c
+ * 16-OCT-2026 keep disk image files open while mounted
+ * 16-OCT-2026 use cluster link map tables for fast seeks
+ * 16-OCT-2026 added write-back track cache
+ * 16-OCT-2026 copy sectors in one go if DMA area is within one bank
+ * 16-OCT-2026 added multi sector FDC commands
+ * 16-OCT-2026 handle the hard disk images together with the disks
+ * 16-OCT-2026 added asynchronous FDC commands executed on core 1
+ * 16-OCT-2026 added sequential read-ahead of tracks on core 1
+ * 16-OCT-2026 added RAM disk for RP2350
+ * 16-OCT-2026 added copy-on-write overlays for disk images
+ * 16-OCT-2026 handle the files of the host file device together with the disks
+ * 16-OCT-2026 use read only disk images write protected
+ * 16-OCT-2026 write back the track cache periodically on core 1
+ * 16-OCT-2026 interrupt after every asynchronous FDC command
  */
 
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "pico/time.h"
+#include "pico/sync.h"
+#include "hardware/sync.h"
 
 #include "sim.h"
 #include "simdefs.h"
 #include "simglb.h"
 #include "simmem.h"
+#include "simio.h"
 
 #include "ff.h"
 #include "f_util.h"
@@ -29,18 +47,123 @@
 
 #include "sd-fdc.h"
 #include "disks.h"
+#include "hdc.h"
+#include "hostfile.h"
 #include "draw.h"
 #include "lcd.h"
 
-FIL sd_file;	/* at any time we have only one file open */
+FIL sd_file;	/* file for loading code and the configuration */
 FRESULT sd_res;	/* result code from FatFS */
 char disks[NUMDISK][DISKLEN]; /* path name for 4 disk images /DISKS80/filename.DSK */
 
 static FATFS fs; /* FatFs on MicroSD */
 
+/* disk image files, kept open while the disk is mounted */
+static FIL dsk_file[NUMDISK];
+static bool dsk_open[NUMDISK];
+bool dsk_wprot[NUMDISK];	/* image could only be opened read only */
+static int dsk_writes[NUMDISK];	/* sector writes since last sync */
+
+/* cluster link map tables for fast seeks in the disk image files */
+static DWORD dsk_clmt[NUMDISK][CLMT_SIZE];
+static uint32_t fat_saved;	/* FAT reads avoided by the fast seeks */
+
+/* write-back track cache */
+#if SPT > 32
+#error "too many sectors per track for the track cache dirty bit map"
+#endif
+typedef struct tcache {
+	int drive;		/* drive of the cached track, -1 if unused */
+	int track;		/* cached track */
+	int nsec;		/* number of sectors read from the image */
+	uint32_t dirty;		/* bit map of modified sectors */
+	uint32_t lru;		/* time stamp of last use */
+	BYTE __aligned(4) buf[SPT * SEC_SZ];
+} tcache_t;
+
+static tcache_t tcache[TCACHE_NUM];
+static uint32_t tc_stamp;	/* LRU time stamp counter */
+static int tc_last_drive = -1;	/* drive of last disk I/O */
+static uint64_t tc_last_io;	/* time of last disk I/O */
+static bool tc_dirty;		/* cache might contain modified tracks */
+static uint32_t tc_read_hits, tc_read_miss, tc_write_hits, tc_write_miss;
+static uint32_t tc_flushes;
+
+/* write back of the track cache after TCACHE_IDLE_MS without disk I/O */
+/* by core 1, so that it doesn't depend on the programs polling the */
+/* console, core 1 holds the mutex while it writes back */
+static volatile bool tc_flush_queued;	/* write back waits for core 1 */
+static absolute_time_t tc_flush_time;	/* time of the write back */
+static mutex_t tc_flush_mutex;
+
+/* read-ahead of tracks for sequential reads, done by core 1 */
+#define PF_FREE		0	/* buffer unused */
+#define PF_QUEUED	1	/* read-ahead waits for/runs on core 1 */
+#define PF_DONE		2	/* track read, waits for use */
+
+typedef struct prefetch {
+	volatile int state;
+	int drive;		/* drive of the track */
+	int track;		/* track to read */
+	int nsec;		/* number of sectors read from the image */
+	BYTE __aligned(4) buf[SPT * SEC_SZ];
+} prefetch_t;
+
+static prefetch_t prefetch[DSK_PREFETCH > 0 ? DSK_PREFETCH : 1];
+static int pf_last_track[NUMDISK];	/* last track read from the drive */
+static uint32_t pf_issued, pf_hits, pf_wasted;
+static uint64_t rd_time;		/* total time of sector reads */
+static uint32_t rd_count;		/* number of sector reads */
+
+/* copy-on-write overlays, the writes go into a delta file next to */
+/* the image with a sector bit map followed by the sectors at their */
+/* position in the image, the image itself is opened read only */
+#define OVL_MAPSZ	256	/* size of the sector bit map */
+#if (TRK + 1) * SPT > OVL_MAPSZ * 8
+#error "sector bit map of the overlays too small"
+#endif
+bool dsk_overlay[NUMDISK];		/* drive uses an overlay */
+static FIL ovl_file[NUMDISK];
+static BYTE ovl_map[NUMDISK][OVL_MAPSZ];
+static bool ovl_map_dirty[NUMDISK];
+
+#ifdef RAMDISK
+/* RAM disk in spare SRAM, same format as the disk images */
+static BYTE __aligned(4) ramdisk[TRK * SPT * SEC_SZ];
+char ramdisk_img[DISKLEN];	/* disk image loaded into the RAM disk */
+static bool ramdisk_dirty;	/* RAM disk modified since load or save */
+#endif
+
+static FRESULT open_disk(int drive);
+static void close_disk(int drive);
+static void sync_disk(int drive);
+static BYTE flush_tcache(int drive);
+static BYTE invalidate_tcache(int drive);
+static void discard_tcache(int drive);
+static void tc_flush_cancel(void);
+static void pf_wait(void);
+static void pf_discard(int drive);
+
 /* buffer for disk/memory transfers */
 static unsigned char __aligned(4) dsk_buf[SEC_SZ];
 
+/* asynchronous FDC command, shared between core 0 and core 1 */
+#define FDC_ASYNC_IDLE		0	/* no command */
+#define FDC_ASYNC_QUEUED	1	/* command waits for/runs on core 1 */
+#define FDC_ASYNC_DONE		2	/* command done, waits for core 0 */
+
+static volatile int fdc_async_state;
+static struct {
+	int drive, track, sector;
+	WORD addr;		/* DMA address */
+	BYTE bank;		/* memory bank at time of the command */
+	bool write;
+	BYTE stat;		/* status set by core 1 */
+} fdc_req;
+static unsigned char __aligned(4) fdc_async_buf[SEC_SZ]; /* sector to write */
+static bool fdc_int;		/* interrupt at end of asynchronous command */
+static BYTE fdc_int_data;	/* RST instruction for the interrupt */
+
 /* global variables for access to MicroSD card */
 
 /* SDIO Interface */
@@ -82,6 +205,18 @@ sd_card_t *sd_get_by_num(size_t num)
 
 void init_disks(void)
 {
+	register int i;
+
+	/* empty track cache */
+	for (i = 0; i < TCACHE_NUM; i++)
+		tcache[i].drive = -1;
+	tc_last_drive = -1;
+	mutex_init(&tc_flush_mutex);
+
+	/* no tracks read ahead */
+	for (i = 0; i < NUMDISK; i++)
+		pf_last_track[i] = -2;
+
 	/* try to mount SD card */
 	sd_res = f_mount(&fs, "", 1);
 	if (sd_res != FR_OK)
@@ -90,10 +225,197 @@ void init_disks(void)
 
 void exit_disks(void)
 {
+	register int i;
+
+	wait_disks();
+
+#ifdef RAMDISK
+	/* save modified RAM disk */
+	if (save_ramdisk() != FDC_STAT_OK)
+		puts("Can't save RAM disk");
+#endif
+
+	/* close all disk image files */
+	for (i = 0; i < NUMDISK; i++)
+		close_disk(i);
+	exit_hdisks();
+	exit_hostfiles();
+
 	/* unmount SD card */
 	f_unmount("");
 }
 
+/*
+ * get the file name of the overlay for drive 'drive',
+ * the disk image name with extension .OVL
+ */
+static void ovl_name(int drive, char *name)
+{
+	strcpy(name, disks[drive]);
+	strcpy(&name[strlen(name) - 3], "OVL");
+}
+
+/*
+ * open or create the overlay of drive 'drive' and read its sector map
+ */
+static FRESULT open_overlay(int drive)
+{
+	char name[DISKLEN];
+	unsigned int br;
+	FRESULT res;
+
+	ovl_name(drive, name);
+	res = f_open(&ovl_file[drive], name,
+		     FA_READ | FA_WRITE | FA_OPEN_ALWAYS);
+	if (res != FR_OK)
+		return res;
+
+	memset(ovl_map[drive], 0, OVL_MAPSZ);
+	if (f_size(&ovl_file[drive]) >= OVL_MAPSZ)
+		res = f_read(&ovl_file[drive], ovl_map[drive], OVL_MAPSZ,
+			     &br);
+	ovl_map_dirty[drive] = false;
+	if (res != FR_OK)
+		f_close(&ovl_file[drive]);
+	return res;
+}
+
+/*
+ * open the disk image file of drive 'drive', if not already open
+ */
+static FRESULT open_disk(int drive)
+{
+	FRESULT res = FR_OK;
+
+	if (!dsk_open[drive]) {
+		pf_wait();
+		dsk_wprot[drive] = false;
+		res = f_open(&dsk_file[drive], disks[drive],
+			     dsk_overlay[drive] ? FA_READ : FA_READ | FA_WRITE);
+		/* read only image or card, or image open in another */
+		/* drive, use it write protected */
+		if ((res == FR_DENIED || res == FR_WRITE_PROTECTED ||
+		     res == FR_LOCKED) && !dsk_overlay[drive]) {
+			res = f_open(&dsk_file[drive], disks[drive], FA_READ);
+			dsk_wprot[drive] = (res == FR_OK);
+		}
+		if (res == FR_OK && dsk_overlay[drive] &&
+		    (res = open_overlay(drive)) != FR_OK)
+			f_close(&dsk_file[drive]);
+		if (res == FR_OK) {
+			dsk_open[drive] = true;
+			dsk_writes[drive] = 0;
+
+			/* create the cluster link map, if the image is too */
+			/* fragmented for the table use normal seeks */
+			dsk_file[drive].cltbl = dsk_clmt[drive];
+			dsk_clmt[drive][0] = CLMT_SIZE;
+			if (f_lseek(&dsk_file[drive], CREATE_LINKMAP) != FR_OK)
+				dsk_file[drive].cltbl = NULL;
+		}
+	}
+	return res;
+}
+
+/*
+ * close the disk image file of drive 'drive', flushes pending writes
+ */
+static void close_disk(int drive)
+{
+	if (dsk_open[drive]) {
+		/* tracks that can't be written back are lost */
+		if (invalidate_tcache(drive) != FDC_STAT_OK)
+			discard_tcache(drive);
+		if (dsk_overlay[drive]) {
+			sync_disk(drive);
+			f_close(&ovl_file[drive]);
+		}
+		f_close(&dsk_file[drive]);
+		dsk_open[drive] = false;
+	}
+}
+
+/*
+ * write pending changes of the image of drive 'drive' to the MicroSD,
+ * for an overlay the sector map too
+ */
+static void sync_disk(int drive)
+{
+	unsigned int bw;
+
+	if (dsk_overlay[drive]) {
+		if (ovl_map_dirty[drive] &&
+		    f_lseek(&ovl_file[drive], 0) == FR_OK &&
+		    f_write(&ovl_file[drive], ovl_map[drive], OVL_MAPSZ,
+			    &bw) == FR_OK)
+			ovl_map_dirty[drive] = false;
+		f_sync(&ovl_file[drive]);
+	} else
+		f_sync(&dsk_file[drive]);
+	dsk_writes[drive] = 0;
+}
+
+/*
+ * switch the overlay of drive 'drive' on or off, changes in the
+ * overlay are kept, but are not visible without the overlay
+ */
+void set_overlay(int drive, bool on)
+{
+	wait_disks();
+	close_disk(drive);
+	dsk_overlay[drive] = on;
+}
+
+/*
+ * discard the overlay of drive 'drive', so that the drive
+ * has the contents of the unmodified disk image again
+ */
+BYTE discard_overlay(int drive)
+{
+	char name[DISKLEN];
+
+	if ((drive < 0) || (drive >= NUMDISK))
+		return FDC_STAT_DISK;
+	if (!dsk_overlay[drive] || !disks[drive][0])
+		return FDC_STAT_OK;
+
+	wait_disks();
+
+	/* forget the cached tracks without writing them back */
+	discard_tcache(drive);
+
+	if (dsk_open[drive]) {
+		f_close(&ovl_file[drive]);
+		f_close(&dsk_file[drive]);
+		dsk_open[drive] = false;
+	}
+	ovl_name(drive, name);
+	sd_res = f_unlink(name);
+	if (sd_res != FR_OK && sd_res != FR_NO_FILE)
+		return FDC_STAT_WRITE;
+	return FDC_STAT_OK;
+}
+
+/*
+ * flush the track cache and pending writes of all open
+ * disk image files to the MicroSD
+ */
+void sync_disks(void)
+{
+	register int i;
+
+	wait_disks();
+	flush_tcache(-1);
+
+	for (i = 0; i < NUMDISK; i++) {
+		if (dsk_open[i] && dsk_writes[i] > 0)
+			sync_disk(i);
+	}
+
+	sync_hdisks();
+	sync_hostfiles();
+}
+
 /*
  * list files with pattern 'ext' in directory 'dir'
  */
@@ -104,6 +426,7 @@ void list_files(const char *dir, const char *ext)
 	FRESULT res;
 	register int i = 0;
 
+	wait_disks();
 	res = f_findfirst(&dp, &fno, dir, ext);
 	if (res == FR_OK) {
 		while (1) {
@@ -135,12 +458,15 @@ bool load_file(const char *name)
 	bool res;
 	register unsigned int j;
 	unsigned int br;
+	BYTE *p;
 	char SFN[25];
 
 	strcpy(SFN, "/CODE80/");
 	strcat(SFN, name);
 	strcat(SFN, ".BIN");
 
+	wait_disks();
+
 	/* try to open file */
 	sd_res = f_open(&sd_file, SFN, FA_READ);
 	if (sd_res != FR_OK) {
@@ -148,10 +474,18 @@ bool load_file(const char *name)
 		return 0;
 	}
 
-	/* read file into memory */
-	while ((sd_res = f_read(&sd_file, &dsk_buf[0], SEC_SZ, &br)) == FR_OK) {
-		for (j = 0; j < br; j++)
-			dma_write(i + j, dsk_buf[j]);
+	/* read file into memory, directly if possible */
+	for (;;) {
+		if ((p = dma_ptr(i, SEC_SZ)) != NULL)
+			sd_res = f_read(&sd_file, p, SEC_SZ, &br);
+		else {
+			sd_res = f_read(&sd_file, &dsk_buf[0], SEC_SZ, &br);
+			if (sd_res == FR_OK)
+				for (j = 0; j < br; j++)
+					dma_write(i + j, dsk_buf[j]);
+		}
+		if (sd_res != FR_OK)
+			break;
 		if (br < SEC_SZ)	/* last record reached */
 			break;
 		i += SEC_SZ;
@@ -175,21 +509,27 @@ void check_disks(void)
 {
 	int i, n = 0;
 
+	wait_disks();
 	for (i = 0; i < NUMDISK; i++) {
 		if (disks[i][0]) {
 			/* try to open file */
-			sd_res = f_open(&sd_file, disks[i], FA_READ);
-			if (sd_res != FR_OK) {
+			sd_res = open_disk(i);
+			if (sd_res == FR_NO_FILE || sd_res == FR_NO_PATH)
 				printf("Disk image \"%s\" no longer exists.\n",
 				       disks[i]);
+			else if (sd_res != FR_OK)
+				printf("Can't open disk image \"%s\": %s (%d)\n",
+				       disks[i], FRESULT_str(sd_res), sd_res);
+			if (sd_res != FR_OK) {
 				disks[i][0] = '\0';
 				n++;
-			} else
-				f_close(&sd_file);
+			}
 		}
 	}
 	if (n > 0)
 		putchar('\n');
+
+	check_hdisks();
 }
 
 /*
@@ -210,128 +550,1235 @@ void mount_disk(int drive, const char *name)
 			return;
 		}
 	}
+#ifdef RAMDISK
+	if (strcmp(ramdisk_img, SFN) == 0) {
+		puts("Disk already loaded into RAM disk\n");
+		return;
+	}
+#endif
+
+	/* close the image currently in the drive */
+	wait_disks();
+	close_disk(drive);
 
 	/* try to open file */
-	sd_res = f_open(&sd_file, SFN, FA_READ);
+	strcpy(disks[drive], SFN);
+	sd_res = open_disk(drive);
 	if (sd_res != FR_OK) {
-		puts("File not found\n");
+		disks[drive][0] = '\0';
+		if (sd_res == FR_NO_FILE)
+			puts("File not found\n");
+		else
+			printf("Can't open disk image: %s (%d)\n\n",
+			       FRESULT_str(sd_res), sd_res);
 		return;
 	}
+	if (dsk_wprot[drive])
+		puts("Disk image is read only, drive is write protected");
 
-	f_close(&sd_file);
-	strcpy(disks[drive], SFN);
 	putchar('\n');
 }
 
 /*
- * prepare I/O for sector read and write routines
+ * remove the disk image from drive 'drive'
  */
-static BYTE prep_io(int drive, int track, int sector, WORD addr)
+void unmount_disk(int drive)
 {
-	FSIZE_t pos;
+	wait_disks();
+	close_disk(drive);
+	disks[drive][0] = '\0';
+}
 
-	/* check if drive in range */
-	if ((drive < 0) || (drive > 3))
-		return FDC_STAT_DISK;
+#ifdef RAMDISK
+/*
+ * load the RAM disk from the disk image in ramdisk_img,
+ * without image or if it can't be read the RAM disk is empty
+ */
+void load_ramdisk(void)
+{
+	unsigned int br;
 
-	/* check if track and sector in range */
-	if (track > TRK)
+	wait_disks();
+
+	/* empty CP/M disk */
+	memset(ramdisk, 0xe5, sizeof(ramdisk));
+	ramdisk_dirty = false;
+	if (!ramdisk_img[0])
+		return;
+
+	sd_res = f_open(&sd_file, ramdisk_img, FA_READ);
+	if (sd_res == FR_OK) {
+		sd_res = f_read(&sd_file, ramdisk, sizeof(ramdisk), &br);
+		f_close(&sd_file);
+	}
+	if (sd_res != FR_OK) {
+		printf("Can't load RAM disk from \"%s\"\n", ramdisk_img);
+		memset(ramdisk, 0xe5, sizeof(ramdisk));
+		ramdisk_img[0] = '\0';
+	}
+}
+
+/*
+ * save the RAM disk into its disk image, if it was modified
+ */
+BYTE save_ramdisk(void)
+{
+	unsigned int bw;
+
+	if (!ramdisk_dirty)
+		return FDC_STAT_OK;
+	if (!ramdisk_img[0])
+		return FDC_STAT_NODISK;
+
+	wait_disks();
+	sd_res = f_open(&sd_file, ramdisk_img, FA_WRITE | FA_OPEN_ALWAYS);
+	if (sd_res != FR_OK)
+		return FDC_STAT_WRITE;
+	sd_res = f_write(&sd_file, ramdisk, sizeof(ramdisk), &bw);
+	f_close(&sd_file);
+	if (sd_res != FR_OK || bw < sizeof(ramdisk))
+		return FDC_STAT_WRITE;
+
+	ramdisk_dirty = false;
+	return FDC_STAT_OK;
+}
+
+/*
+ * load disk image 'name' into the RAM disk, an empty 'name'
+ * gives an empty RAM disk without image
+ */
+void mount_ramdisk(const char *name)
+{
+	char SFN[DISKLEN];
+	int i;
+
+	if (*name) {
+		strcpy(SFN, "/DISKS80/");
+		strcat(SFN, name);
+		strcat(SFN, ".DSK");
+
+		for (i = 0; i < NUMDISK; i++) {
+			if (strcmp(disks[i], SFN) == 0) {
+				puts("Disk already mounted\n");
+				return;
+			}
+		}
+	} else
+		SFN[0] = '\0';
+
+	/* keep the contents of the current image */
+	if (save_ramdisk() != FDC_STAT_OK)
+		puts("Can't save RAM disk");
+
+	strcpy(ramdisk_img, SFN);
+	load_ramdisk();
+	putchar('\n');
+}
+
+/*
+ * transfer 'count' sectors, 0 for the rest of the track, starting
+ * with sector on track, between the RAM disk and memory @ addr
+ */
+static BYTE ramdisk_io(int track, int sector, int count, WORD addr,
+		       bool write)
+{
+	register BYTE *p, *m;
+	register unsigned int i;
+	unsigned int len;
+
+	if (track >= TRK)
 		return FDC_STAT_TRACK;
 	if ((sector < 1) || (sector > SPT))
 		return FDC_STAT_SEC;
-
-	/* check if DMA address in range */
-	if (addr > 0xff7f)
+	if (count == 0)
+		count = SPT - sector + 1;
+	if (track * SPT + sector - 1 + count > TRK * SPT)
+		return FDC_STAT_TRACK;
+	len = count * SEC_SZ;
+	if ((unsigned int) addr + len > 0xff00)
 		return FDC_STAT_DMAADR;
 
-	/* check if disk in drive */
-	if (!strlen(disks[drive])) {
-		return FDC_STAT_NODISK;
+	p = &ramdisk[(track * SPT + sector - 1) * SEC_SZ];
+	if ((m = dma_ptr(addr, len)) != NULL) {
+		if (write)
+			memcpy(p, m, len);
+		else
+			memcpy(m, p, len);
+	} else {
+		for (i = 0; i < len; i++) {
+			if (write)
+				p[i] = dma_read(addr + i);
+			else
+				dma_write(addr + i, p[i]);
+		}
 	}
+	if (write)
+		ramdisk_dirty = true;
 
-	/* open file with the disk image */
-	sd_res = f_open(&sd_file, disks[drive], FA_READ | FA_WRITE);
-	if (sd_res != FR_OK)
-		return FDC_STAT_NODISK;
+	return FDC_STAT_OK;
+}
+#endif
+
+/*
+ * print statistics of the disk drives
+ */
+void report_disk_stats(void)
+{
+	uint32_t n;
+
+	printf("Disk FAT reads avoided by fast seeks: %lu\n",
+	       (unsigned long) fat_saved);
+	n = tc_read_hits + tc_read_miss;
+	printf("Disk track cache reads: %lu, hits: %lu (%lu%%)\n",
+	       (unsigned long) n, (unsigned long) tc_read_hits,
+	       (unsigned long) (n ? (uint64_t) tc_read_hits * 100 / n : 0));
+	n = tc_write_hits + tc_write_miss;
+	printf("Disk track cache writes: %lu, hits: %lu (%lu%%)\n",
+	       (unsigned long) n, (unsigned long) tc_write_hits,
+	       (unsigned long) (n ? (uint64_t) tc_write_hits * 100 / n : 0));
+	printf("Disk track cache flushes: %lu\n", (unsigned long) tc_flushes);
+	printf("Disk tracks read ahead: %lu, hits: %lu, wasted: %lu\n",
+	       (unsigned long) pf_issued, (unsigned long) pf_hits,
+	       (unsigned long) pf_wasted);
+	printf("Disk sector reads: %lu, average latency: %lu us\n",
+	       (unsigned long) rd_count,
+	       (unsigned long) (rd_count ? rd_time / rd_count : 0));
+}
+
+/*
+ * count the FAT reads a normal seek from file position 'from'
+ * to 'to' would have needed to follow the cluster chain
+ */
+static void count_fat_saved(FIL *fp, FSIZE_t from, FSIZE_t to)
+{
+	FSIZE_t bcs = (FSIZE_t) fp->obj.fs->csize * FF_MIN_SS;
+
+	if (to == 0)
+		return;
+	if (from > 0 && (to - 1) / bcs >= (from - 1) / bcs)
+		fat_saved += (to - 1) / bcs - (from - 1) / bcs;
+	else
+		fat_saved += (to - 1) / bcs;
+}
+
+/*
+ * seek to track/sector in the disk image of drive 'drive'
+ */
+static FRESULT seek_disk(int drive, int track, int sector)
+{
+	FSIZE_t pos;
+	FIL *fp = &dsk_file[drive];
 
-	/* seek to track/sector */
 	pos = (((FSIZE_t) track * (FSIZE_t) SPT) + sector - 1) * SEC_SZ;
-	if (f_lseek(&sd_file, pos) != FR_OK) {
-		f_close(&sd_file);
+	if (fp->cltbl != NULL)
+		count_fat_saved(fp, f_tell(fp), pos);
+	return f_lseek(fp, pos);
+}
+
+/*
+ * write sectors 'first' to 'last' (counted from 0) of track
+ * from 'buf' into the overlay of drive 'drive'
+ */
+static BYTE write_overlay(int drive, int track, int first, int last,
+			  BYTE *buf)
+{
+	FIL *fp = &ovl_file[drive];
+	unsigned int bw, len = (last - first + 1) * SEC_SZ;
+	register int n = track * SPT + first;
+
+	if (f_lseek(fp, OVL_MAPSZ + (FSIZE_t) n * SEC_SZ) != FR_OK)
 		return FDC_STAT_SEEK;
-	}
+	sd_res = f_write(fp, buf, len, &bw);
+	if (sd_res != FR_OK || bw < len)
+		return FDC_STAT_WRITE;
+
+	for (; first <= last; first++, n++)
+		ovl_map[drive][n >> 3] |= 1 << (n & 7);
+	ovl_map_dirty[drive] = true;
 	return FDC_STAT_OK;
 }
 
 /*
- * read from drive a sector on track into memory @ addr
+ * replace the sectors of track of drive 'drive' in 'buf', which
+ * were read from the disk image, with the ones in the overlay
  */
-BYTE read_sec(int drive, int track, int sector, WORD addr)
+static BYTE read_overlay(int drive, int track, int nsec, BYTE *buf)
 {
-	BYTE stat;
-	unsigned int br;
-	register int i;
+	FIL *fp = &ovl_file[drive];
+	unsigned int br, len;
+	register int i, j, n = track * SPT;
 
-	led_color = (led_color & ~C_GREEN) | C_GREEN;
+	for (i = 0; i < nsec; i++) {
+		if (!(ovl_map[drive][(n + i) >> 3] & (1 << ((n + i) & 7))))
+			continue;
 
-	/* prepare for sector read */
-	if ((stat = prep_io(drive, track, sector, addr)) == FDC_STAT_OK) {
+		/* read consecutive sectors in the overlay in one go */
+		for (j = i + 1; j < nsec; j++)
+			if (!(ovl_map[drive][(n + j) >> 3] &
+			      (1 << ((n + j) & 7))))
+				break;
+		len = (j - i) * SEC_SZ;
+		if (f_lseek(fp, OVL_MAPSZ + (FSIZE_t) (n + i) * SEC_SZ)
+		    != FR_OK)
+			return FDC_STAT_SEEK;
+		sd_res = f_read(fp, &buf[i * SEC_SZ], len, &br);
+		if (sd_res != FR_OK || br < len)
+			return FDC_STAT_READ;
+		i = j;
+	}
+	return FDC_STAT_OK;
+}
 
-		/* read sector into memory */
-		sd_res = f_read(&sd_file, &dsk_buf[0], SEC_SZ, &br);
-		if (sd_res == FR_OK) {
-			if (br < SEC_SZ)	/* UH OH */
-				stat = FDC_STAT_READ;
-			else {
-				for (i = 0; i < SEC_SZ; i++)
-					dma_write(addr + i, dsk_buf[i]);
-				stat = FDC_STAT_OK;
-			}
-		} else
-			stat = FDC_STAT_READ;
+/*
+ * write the modified sectors of a track cache slot back to the disk image
+ */
+static BYTE flush_slot(tcache_t *tc)
+{
+	int first, last;
+	unsigned int br, len;
+	BYTE stat = FDC_STAT_OK;
 
-		f_close(&sd_file);
+	if (tc->dirty == 0)
+		return FDC_STAT_OK;
+
+	/* write everything from first to last modified sector in one go */
+	first = __builtin_ctz(tc->dirty);
+	last = 31 - __builtin_clz(tc->dirty);
+	len = (last - first + 1) * SEC_SZ;
+
+	if (dsk_overlay[tc->drive])
+		stat = write_overlay(tc->drive, tc->track, first, last,
+				     &tc->buf[first * SEC_SZ]);
+	else if (seek_disk(tc->drive, tc->track, first + 1) != FR_OK)
+		stat = FDC_STAT_SEEK;
+	else {
+		sd_res = f_write(&dsk_file[tc->drive], &tc->buf[first * SEC_SZ],
+				 len, &br);
+		if (sd_res != FR_OK || br < len)
+			stat = FDC_STAT_WRITE;
 	}
 
-	led_color &= ~C_GREEN;
+	/* the sectors stay modified, if they couldn't be written */
+	if (stat != FDC_STAT_OK)
+		return stat;
 
-	return stat;
+	/* sync the image after DSK_SYNC_WRITES sector writes */
+	dsk_writes[tc->drive] += last - first + 1;
+	if (dsk_writes[tc->drive] >= DSK_SYNC_WRITES)
+		sync_disk(tc->drive);
+
+	tc->dirty = 0;
+	tc_flushes++;
+	return FDC_STAT_OK;
 }
 
 /*
- * write to drive a sector on track from memory @ addr
+ * write back all modified track cache slots of drive 'drive',
+ * or of all drives if 'drive' is -1, returns the first error
  */
-BYTE write_sec(int drive, int track, int sector, WORD addr)
+static BYTE flush_tcache(int drive)
 {
-	BYTE stat;
-	unsigned int br;
+	BYTE stat = FDC_STAT_OK, s;
 	register int i;
 
-	led_color = (led_color & ~C_RED) | C_RED;
+	for (i = 0; i < TCACHE_NUM; i++)
+		if (tcache[i].drive >= 0 &&
+		    (drive < 0 || tcache[i].drive == drive) &&
+		    (s = flush_slot(&tcache[i])) != FDC_STAT_OK &&
+		    stat == FDC_STAT_OK)
+			stat = s;
+	if (drive < 0 && stat == FDC_STAT_OK)
+		tc_dirty = false;
+	return stat;
+}
 
-	/* prepare for sector write */
-	if ((stat = prep_io(drive, track, sector, addr)) == FDC_STAT_OK) {
+/*
+ * write back and discard all track cache slots of drive 'drive',
+ * slots that can't be written back are kept
+ */
+static BYTE invalidate_tcache(int drive)
+{
+	BYTE stat = FDC_STAT_OK, s;
+	register int i;
 
-		/* write sector to disk image */
-		for (i = 0; i < SEC_SZ; i++)
-			dsk_buf[i] = dma_read(addr + i);
-		sd_res = f_write(&sd_file, &dsk_buf[0], SEC_SZ, &br);
-		if (sd_res == FR_OK) {
-			if (br < SEC_SZ)	/* UH OH */
-				stat = FDC_STAT_WRITE;
-			else
-				stat = FDC_STAT_OK;
-		} else
-			stat = FDC_STAT_WRITE;
+	for (i = 0; i < TCACHE_NUM; i++)
+		if (tcache[i].drive == drive) {
+			if ((s = flush_slot(&tcache[i])) == FDC_STAT_OK)
+				tcache[i].drive = -1;
+			else if (stat == FDC_STAT_OK)
+				stat = s;
+		}
+	pf_discard(drive);
+	return stat;
+}
 
-		f_close(&sd_file);
-	}
+/*
+ * discard all track cache slots of drive 'drive'
+ * without writing them back
+ */
+static void discard_tcache(int drive)
+{
+	register int i;
 
-	led_color &= ~C_RED;
+	for (i = 0; i < TCACHE_NUM; i++)
+		if (tcache[i].drive == drive)
+			tcache[i].drive = -1;
+	pf_discard(drive);
+}
+
+/*
+ * queue the write back of the track cache for core 1,
+ * after TCACHE_IDLE_MS without disk I/O
+ */
+static void tc_flush_queue(void)
+{
+	mutex_enter_blocking(&tc_flush_mutex);
+	tc_flush_time = make_timeout_time_ms(TCACHE_IDLE_MS);
+	tc_flush_queued = true;
+	mutex_exit(&tc_flush_mutex);
+}
+
+/*
+ * take the track cache back from core 1, waits if
+ * the write back is running already
+ */
+static void tc_flush_cancel(void)
+{
+	if (tc_flush_queued) {
+		mutex_enter_blocking(&tc_flush_mutex);
+		tc_flush_queued = false;
+		mutex_exit(&tc_flush_mutex);
+	}
+}
+
+/*
+ * write back the track cache on core 1 when it is time,
+ * retried later if it fails
+ */
+static void tc_flush_work(void)
+{
+	register int i;
+
+	if (!tc_flush_queued || !mutex_try_enter(&tc_flush_mutex, NULL))
+		return;
+	if (tc_flush_queued && time_reached(tc_flush_time)) {
+		if (flush_tcache(-1) == FDC_STAT_OK) {
+			for (i = 0; i < NUMDISK; i++)
+				if (dsk_open[i] && dsk_writes[i] > 0)
+					sync_disk(i);
+			__dmb();
+			tc_flush_queued = false;
+		} else
+			tc_flush_time = make_timeout_time_ms(TCACHE_IDLE_MS);
+	}
+	mutex_exit(&tc_flush_mutex);
+}
+
+/*
+ * write back modified track cache slots and sync all files, if there
+ * was no disk I/O for TCACHE_IDLE_MS, called from the console status
+ * port which is polled by all operating systems when idle, the track
+ * cache alone is also written back by core 1, written hard disk
+ * images are synced after their own idle time
+ */
+void idle_disks(void)
+{
+	register int i;
+
+	if (fdc_async_state != FDC_ASYNC_IDLE)
+		return;
+	for (i = 0; i < DSK_PREFETCH; i++)
+		if (prefetch[i].state == PF_QUEUED)
+			return;
+	if (tc_dirty && (time_us_64() - tc_last_io) >= TCACHE_IDLE_MS * 1000)
+		sync_disks();
+	else
+		idle_hdisks();
+}
+
+/*
+ * wait until core 1 has finished all queued track read-aheads,
+ * must be done before core 0 uses FatFS
+ */
+static void pf_wait(void)
+{
+	register int i;
+
+	tc_flush_cancel();
+	for (i = 0; i < DSK_PREFETCH; i++)
+		while (prefetch[i].state == PF_QUEUED)
+			__wfe();
+	__dmb();
+}
+
+/*
+ * discard the tracks read ahead for drive 'drive', or of all
+ * drives if 'drive' is -1, because the image was changed or closed
+ */
+static void pf_discard(int drive)
+{
+	register int i;
+
+	pf_wait();
+	for (i = 0; i < DSK_PREFETCH; i++)
+		if (prefetch[i].state == PF_DONE &&
+		    (drive < 0 || prefetch[i].drive == drive)) {
+			prefetch[i].state = PF_FREE;
+			pf_wasted++;
+		}
+}
+
+/*
+ * read of 'track' from drive 'drive' done, if the reads are
+ * sequential queue the next tracks for reading ahead on core 1
+ */
+static void pf_issue(int drive, int track)
+{
+	register int i, j;
+	int next, last = pf_last_track[drive];
+	prefetch_t *pf;
+
+	pf_last_track[drive] = track;
+	if (track != last && track != last + 1)
+		return;
+	if (fdc_async_state != FDC_ASYNC_IDLE)
+		return;
+
+	for (next = track + 1; next <= track + DSK_PREFETCH && next < TRK;
+	     next++) {
+		/* already cached or read ahead ? */
+		for (i = 0; i < TCACHE_NUM; i++)
+			if (tcache[i].drive == drive &&
+			    tcache[i].track == next)
+				break;
+		if (i < TCACHE_NUM)
+			continue;
+		for (i = 0; i < DSK_PREFETCH; i++)
+			if (prefetch[i].state != PF_FREE &&
+			    prefetch[i].drive == drive &&
+			    prefetch[i].track == next)
+				break;
+		if (i < DSK_PREFETCH)
+			continue;
+
+		/* use a free buffer, or one with a track before 'track' */
+		pf = NULL;
+		for (j = 0; j < DSK_PREFETCH; j++) {
+			if (prefetch[j].state == PF_FREE) {
+				pf = &prefetch[j];
+				break;
+			}
+			if (prefetch[j].state == PF_DONE &&
+			    (prefetch[j].drive != drive ||
+			     prefetch[j].track <= track)) {
+				pf = &prefetch[j];
+				pf_wasted++;
+				break;
+			}
+		}
+		if (pf == NULL)
+			break;
+
+		pf->drive = drive;
+		pf->track = next;
+		pf_issued++;
+		__dmb();
+		pf->state = PF_QUEUED;
+		__sev();
+	}
+}
+
+/*
+ * read the queued tracks ahead, runs on core 1
+ */
+static void pf_work(void)
+{
+	register int i;
+	prefetch_t *pf;
+	unsigned int br;
+
+	for (i = 0; i < DSK_PREFETCH; i++) {
+		pf = &prefetch[i];
+		if (pf->state != PF_QUEUED)
+			continue;
+		__dmb();
+		if (seek_disk(pf->drive, pf->track, 1) == FR_OK &&
+		    f_read(&dsk_file[pf->drive], pf->buf, sizeof(pf->buf),
+			   &br) == FR_OK)
+			pf->nsec = br / SEC_SZ;
+		else
+			pf->nsec = 0;
+		__dmb();
+		pf->state = PF_DONE;
+		__sev();
+	}
+}
+
+/*
+ * get the cache slot with track 'track' of drive 'drive',
+ * the track is read from the disk image if not cached
+ */
+static tcache_t *get_track(int drive, int track, bool write, BYTE *stat)
+{
+	register int i;
+	tcache_t *tc, *lru = NULL;
+	prefetch_t *pf;
+	unsigned int br;
+
+	/* the track cache can't be written back by core 1 now */
+	tc_flush_cancel();
+
+	/* new drive, write back modified tracks of the previous one */
+	if (drive != tc_last_drive) {
+		if (tc_last_drive >= 0) {
+			pf_wait();
+			flush_tcache(tc_last_drive);
+		}
+		tc_last_drive = drive;
+	}
+	tc_last_io = time_us_64();
+
+	for (i = 0; i < TCACHE_NUM; i++) {
+		tc = &tcache[i];
+		if (tc->drive == drive && tc->track == track) {
+			if (write)
+				tc_write_hits++;
+			else
+				tc_read_hits++;
+			tc->lru = ++tc_stamp;
+			return tc;
+		}
+		if (lru == NULL || tc->drive < 0 ||
+		    (lru->drive >= 0 && tc->lru < lru->lru))
+			lru = tc;
+	}
+	if (write)
+		tc_write_miss++;
+	else
+		tc_read_miss++;
+
+	/* FatFS is needed, wait until read-ahead is done */
+	pf_wait();
+
+	/* evict the least recently used slot */
+	tc = lru;
+	if (tc->drive >= 0 && (*stat = flush_slot(tc)) != FDC_STAT_OK)
+		return NULL;
+	tc->drive = -1;
+
+	/* take the track from the read-ahead buffers, if it is there */
+	for (i = 0; i < DSK_PREFETCH; i++) {
+		pf = &prefetch[i];
+		if (pf->state == PF_DONE && pf->drive == drive &&
+		    pf->track == track && pf->nsec > 0) {
+			memcpy(tc->buf, pf->buf, sizeof(tc->buf));
+			tc->nsec = pf->nsec;
+			pf->state = PF_FREE;
+			pf_hits++;
+			break;
+		}
+	}
+
+	/* else read the whole track into it */
+	if (i == DSK_PREFETCH) {
+		if (seek_disk(drive, track, 1) != FR_OK) {
+			*stat = FDC_STAT_SEEK;
+			return NULL;
+		}
+		sd_res = f_read(&dsk_file[drive], tc->buf, sizeof(tc->buf),
+				&br);
+		if (sd_res != FR_OK) {
+			*stat = FDC_STAT_READ;
+			return NULL;
+		}
+		tc->nsec = br / SEC_SZ;	/* last track might be short */
+	}
+	if (dsk_overlay[drive] &&
+	    (*stat = read_overlay(drive, track, tc->nsec,
+				  tc->buf)) != FDC_STAT_OK)
+		return NULL;
+	tc->drive = drive;
+	tc->track = track;
+	tc->dirty = 0;
+	tc->lru = ++tc_stamp;
+	return tc;
+}
+
+/*
+ * prepare I/O for sector read and write routines
+ */
+static BYTE prep_io(int drive, int track, int sector, WORD addr)
+{
+	/* check if drive in range */
+	if ((drive < 0) || (drive >= NUMDISK))
+		return FDC_STAT_DISK;
+
+	/* check if track and sector in range */
+	if (track >= TRK)
+		return FDC_STAT_TRACK;
+	if ((sector < 1) || (sector > SPT))
+		return FDC_STAT_SEC;
+
+	/* check if DMA address in range */
+	if (addr > 0xff7f)
+		return FDC_STAT_DMAADR;
+
+	/* check if disk in drive */
+	if (!strlen(disks[drive])) {
+		return FDC_STAT_NODISK;
+	}
+
+	/* open file with the disk image, if not done yet */
+	sd_res = open_disk(drive);
+	if (sd_res != FR_OK)
+		return FDC_STAT_NODISK;
+
+	return FDC_STAT_OK;
+}
+
+/*
+ * get a pointer to a sector on track of drive in the track cache,
+ * the sector is marked as modified for a write
+ */
+static BYTE *get_sec(int drive, int track, int sector, bool write, BYTE *stat)
+{
+	tcache_t *tc;
+
+	if (write && dsk_wprot[drive]) {
+		*stat = FDC_STAT_WRITE;
+		return NULL;
+	}
+	if ((tc = get_track(drive, track, write, stat)) == NULL)
+		return NULL;
+	if (sector > tc->nsec) {	/* UH OH */
+		*stat = write ? FDC_STAT_WRITE : FDC_STAT_READ;
+		return NULL;
+	}
+	if (write) {
+		tc->dirty |= 1U << (sector - 1);
+		tc_dirty = true;
+	}
+	return &tc->buf[(sector - 1) * SEC_SZ];
+}
+
+/*
+ * read from drive a sector on track into memory @ addr
+ */
+BYTE read_sec(int drive, int track, int sector, WORD addr)
+{
+	BYTE stat;
+	register BYTE *p, *m;
+	register int i;
+	uint64_t t = time_us_64();
+
+#ifdef RAMDISK
+	if (drive == RAMDISK)
+		return ramdisk_io(track, sector, 1, addr, false);
+#endif
+
+	led_color = (led_color & ~C_GREEN) | C_GREEN;
+
+	/* prepare for sector read */
+	if ((stat = prep_io(drive, track, sector, addr)) == FDC_STAT_OK) {
+
+		/* get the sector from the track cache */
+		if ((p = get_sec(drive, track, sector, false, &stat)) != NULL) {
+			/* copy sector into memory */
+			if ((m = dma_ptr(addr, SEC_SZ)) != NULL)
+				memcpy(m, p, SEC_SZ);
+			else
+				for (i = 0; i < SEC_SZ; i++)
+					dma_write(addr + i, *p++);
+
+			/* read ahead, if reading sequential */
+			if (DSK_PREFETCH > 0)
+				pf_issue(drive, track);
+		}
+	}
+
+	led_color &= ~C_GREEN;
+
+	rd_time += time_us_64() - t;
+	rd_count++;
+
+	return stat;
+}
+
+/*
+ * write to drive a sector on track from memory @ addr
+ */
+BYTE write_sec(int drive, int track, int sector, WORD addr)
+{
+	BYTE stat;
+	register BYTE *p, *m;
+	register int i;
+
+#ifdef RAMDISK
+	if (drive == RAMDISK)
+		return ramdisk_io(track, sector, 1, addr, true);
+#endif
+
+	led_color = (led_color & ~C_RED) | C_RED;
+
+	/* prepare for sector write */
+	if ((stat = prep_io(drive, track, sector, addr)) == FDC_STAT_OK) {
+
+		/* get the sector from the track cache */
+		if ((p = get_sec(drive, track, sector, true, &stat)) != NULL) {
+			/* copy sector from memory into the cache */
+			if ((m = dma_ptr(addr, SEC_SZ)) != NULL)
+				memcpy(p, m, SEC_SZ);
+			else
+				for (i = 0; i < SEC_SZ; i++)
+					*p++ = dma_read(addr + i);
+			tc_flush_queue();
+		}
+	}
+
+	led_color &= ~C_RED;
 
 	return stat;
 }
 
+/*
+ * prepare I/O for multi sector read and write routines,
+ * 'count' == 0 transfers the rest of the track
+ */
+static BYTE prep_multi_io(int drive, int track, int sector, int *count,
+			  WORD addr)
+{
+	BYTE stat;
+	int last;
+
+	if ((stat = prep_io(drive, track, sector, addr)) != FDC_STAT_OK)
+		return stat;
+
+	if (*count == 0)
+		*count = SPT - sector + 1;
+
+	/* check if the last sector is on a valid track */
+	last = track * SPT + sector - 1 + *count - 1;
+	if (last / SPT >= TRK)
+		return FDC_STAT_TRACK;
+
+	/* check if the whole DMA area is in range */
+	if ((unsigned int) addr + *count * SEC_SZ > 0xff00)
+		return FDC_STAT_DMAADR;
+
+	return FDC_STAT_OK;
+}
+
+/*
+ * transfer 'count' consecutive sectors of a drive with overlay
+ * sector by sector through the track cache
+ */
+static BYTE ovl_secs(int drive, int track, int sector, int count, WORD addr,
+		     bool write)
+{
+	BYTE stat;
+	register int i;
+
+	if ((stat = prep_multi_io(drive, track, sector, &count,
+				  addr)) != FDC_STAT_OK)
+		return stat;
+
+	for (i = 0; i < count; i++) {
+		if (write)
+			stat = write_sec(drive, track, sector, addr);
+		else
+			stat = read_sec(drive, track, sector, addr);
+		if (stat != FDC_STAT_OK)
+			break;
+		addr += SEC_SZ;
+		if (++sector > SPT) {
+			sector = 1;
+			track++;
+		}
+	}
+	return stat;
+}
+
+/*
+ * read from drive 'count' consecutive sectors, starting with
+ * sector on track, into memory @ addr
+ */
+BYTE read_secs(int drive, int track, int sector, int count, WORD addr)
+{
+	BYTE stat;
+	unsigned int br, len;
+	register BYTE *m;
+	register int i, j;
+
+#ifdef RAMDISK
+	if (drive == RAMDISK)
+		return ramdisk_io(track, sector, count, addr, false);
+#endif
+	if ((drive >= 0) && (drive < NUMDISK) && dsk_overlay[drive])
+		return ovl_secs(drive, track, sector, count, addr, false);
+
+	led_color = (led_color & ~C_GREEN) | C_GREEN;
+
+	/* prepare for multi sector read and bring the image */
+	/* up to date, the cached tracks stay valid */
+	if ((stat = prep_multi_io(drive, track, sector, &count,
+				  addr)) == FDC_STAT_OK &&
+	    (stat = flush_tcache(drive)) == FDC_STAT_OK) {
+		tc_last_io = time_us_64();
+
+		if (seek_disk(drive, track, sector) != FR_OK)
+			stat = FDC_STAT_SEEK;
+		else if ((m = dma_ptr(addr, count * SEC_SZ)) != NULL) {
+			/* read all sectors directly into memory */
+			len = count * SEC_SZ;
+			sd_res = f_read(&dsk_file[drive], m, len, &br);
+			if (sd_res != FR_OK || br < len)
+				stat = FDC_STAT_READ;
+		} else {
+			/* DMA area crosses banks, go sector by sector */
+			for (i = 0; i < count; i++) {
+				sd_res = f_read(&dsk_file[drive], &dsk_buf[0],
+						SEC_SZ, &br);
+				if (sd_res != FR_OK || br < SEC_SZ) {
+					stat = FDC_STAT_READ;
+					break;
+				}
+				for (j = 0; j < SEC_SZ; j++)
+					dma_write(addr++, dsk_buf[j]);
+			}
+		}
+	}
+
+	led_color &= ~C_GREEN;
+
+	return stat;
+}
+
+/*
+ * write to drive 'count' consecutive sectors, starting with
+ * sector on track, from memory @ addr
+ */
+BYTE write_secs(int drive, int track, int sector, int count, WORD addr)
+{
+	BYTE stat;
+	unsigned int br, len;
+	register BYTE *m;
+	register int i, j;
+
+#ifdef RAMDISK
+	if (drive == RAMDISK)
+		return ramdisk_io(track, sector, count, addr, true);
+#endif
+	if ((drive >= 0) && (drive < NUMDISK) && dsk_overlay[drive])
+		return ovl_secs(drive, track, sector, count, addr, true);
+
+	led_color = (led_color & ~C_RED) | C_RED;
+
+	/* prepare for multi sector write, the cached */
+	/* tracks of the drive become stale */
+	if ((stat = prep_multi_io(drive, track, sector, &count,
+				  addr)) == FDC_STAT_OK &&
+	    (stat = invalidate_tcache(drive)) == FDC_STAT_OK) {
+		tc_last_io = time_us_64();
+
+		if (dsk_wprot[drive])
+			stat = FDC_STAT_WRITE;
+		else if (seek_disk(drive, track, sector) != FR_OK)
+			stat = FDC_STAT_SEEK;
+		else if ((m = dma_ptr(addr, count * SEC_SZ)) != NULL) {
+			/* write all sectors directly from memory */
+			len = count * SEC_SZ;
+			sd_res = f_write(&dsk_file[drive], m, len, &br);
+			if (sd_res != FR_OK || br < len)
+				stat = FDC_STAT_WRITE;
+		} else {
+			/* DMA area crosses banks, go sector by sector */
+			for (i = 0; i < count; i++) {
+				for (j = 0; j < SEC_SZ; j++)
+					dsk_buf[j] = dma_read(addr++);
+				sd_res = f_write(&dsk_file[drive], &dsk_buf[0],
+						 SEC_SZ, &br);
+				if (sd_res != FR_OK || br < SEC_SZ) {
+					stat = FDC_STAT_WRITE;
+					break;
+				}
+			}
+		}
+
+		/* sync the image after DSK_SYNC_WRITES sector writes */
+		dsk_writes[drive] += count;
+		if (dsk_writes[drive] >= DSK_SYNC_WRITES)
+			sync_disk(drive);
+	}
+
+	led_color &= ~C_RED;
+
+	return stat;
+}
+
+/*
+ *	Extension of the SD-FDC from z80pack with multi sector and
+ *	asynchronous commands, all other commands are passed to the
+ *	SD-FDC.
+ *
+ *	I/O port 4 write, bits 4-7 command, bits 0-3 drive:
+ *	1 = set address of the command bytes, LSB and MSB follow
+ *	2 = read sector
+ *	3 = read multiple sectors
+ *	4 = write sector
+ *	5 = write multiple sectors
+ *	6 = interrupt for asynchronous commands, bit 3 enables,
+ *	    bits 0-2 select the RST instruction
+ *	7 = save the RAM disk into its disk image
+ *	8 = discard the overlay of the drive
+ *	A = asynchronous read sector
+ *	C = asynchronous write sector
+ *
+ *	The multi sector commands use a fifth command byte with the
+ *	number of sectors, 0 transfers the rest of the track. The
+ *	transfer continues with sector 1 of the next track.
+ *
+ *	The asynchronous commands return immediately and the transfer
+ *	with the MicroSD is done by core 1, while the CPU continues.
+ *	Until the transfer is finished the status is FDC_STAT_BUSY,
+ *	bus request is active and the memory of a read sector isn't
+ *	updated yet. The memory is updated before the status changes.
+ *	With the interrupt enabled it is requested at the end of every
+ *	asynchronous command, after the status is available.
+ */
+
+static WORD fdc_cmd_addr;	/* address of the command bytes */
+static int fdc_state;		/* 1,2 = LSB/MSB of address follows */
+static bool fdc_ext;		/* last command was handled here */
+static BYTE fdc_ext_stat;	/* its status */
+
+/*
+ * request the interrupt at the end of an asynchronous command
+ */
+static void fdc_async_int(void)
+{
+	if (fdc_int) {
+		int_data = fdc_int_data;
+		__dmb();	/* core 0 must see the data first */
+		int_int = 1;
+	}
+}
+
+/*
+ * finish an asynchronous command done by core 1
+ */
+static void fdc_async_finish(void)
+{
+	__dmb();
+	fdc_ext_stat = fdc_req.stat;
+	led_color &= ~(fdc_req.write ? C_RED : C_GREEN);
+	bus_request = 0;
+	fdc_async_state = FDC_ASYNC_IDLE;
+}
+
+/*
+ * wait until an asynchronous command is finished
+ */
+static void fdc_async_wait(void)
+{
+	if (fdc_async_state == FDC_ASYNC_IDLE)
+		return;
+	while (fdc_async_state == FDC_ASYNC_QUEUED)
+		__wfe();
+	fdc_async_finish();
+}
+
+/*
+ * wait until all disk I/O on core 1 is finished, must be
+ * called before using FatFS or the track cache on core 0
+ */
+void wait_disks(void)
+{
+	fdc_async_wait();
+	pf_wait();
+}
+
+/*
+ * queue an asynchronous sector read or write for core 1
+ */
+static void fdc_async_queue(int drive, bool write)
+{
+	BYTE cmd[4];
+	register int i;
+
+	get_fdccmd(cmd, fdc_cmd_addr);
+	fdc_req.drive = drive;
+	fdc_req.track = cmd[FDCMD_TRK];
+	fdc_req.sector = cmd[FDCMD_SEC];
+	fdc_req.addr = cmd[FDCMD_DMAL] | (cmd[FDCMD_DMAH] << 8);
+	fdc_req.bank = selbnk;
+	fdc_req.write = write;
+
+#ifdef RAMDISK
+	/* the RAM disk is fast enough without core 1 */
+	if (drive == RAMDISK) {
+		fdc_ext_stat = ramdisk_io(fdc_req.track, fdc_req.sector, 1,
+					  fdc_req.addr, write);
+		fdc_async_int();
+		return;
+	}
+#endif
+
+	/* check DMA address here, prep_io() on core 1 doesn't know it */
+	if (fdc_req.addr > 0xff7f) {
+		fdc_ext_stat = FDC_STAT_DMAADR;
+		fdc_async_int();
+		return;
+	}
+
+	if (write) {
+		for (i = 0; i < SEC_SZ; i++)
+			fdc_async_buf[i] = dma_read(fdc_req.addr + i);
+		led_color = (led_color & ~C_RED) | C_RED;
+	} else
+		led_color = (led_color & ~C_GREEN) | C_GREEN;
+
+	fdc_ext_stat = FDC_STAT_BUSY;
+	bus_request = 1;
+	__dmb();
+	fdc_async_state = FDC_ASYNC_QUEUED;
+	__sev();
+}
+
+/*
+ * execute queued asynchronous commands and read-aheads on core 1
+ * until time 'until' is reached, called from the LCD task between
+ * the refreshs of the display
+ */
+void fdc_async_work(absolute_time_t until)
+{
+	bool cmd;
+	BYTE stat;
+	register BYTE *p;
+	register WORD addr;
+	register int i;
+
+	for (;;) {
+		/* read-aheads first, they were queued before a command */
+		cmd = fdc_async_state == FDC_ASYNC_QUEUED;
+		__dmb();
+		if (DSK_PREFETCH > 0)
+			pf_work();
+		tc_flush_work();
+		if (cmd) {
+			if ((stat = prep_io(fdc_req.drive, fdc_req.track,
+					    fdc_req.sector, 0)) == FDC_STAT_OK &&
+			    (p = get_sec(fdc_req.drive, fdc_req.track,
+					 fdc_req.sector, fdc_req.write,
+					 &stat)) != NULL) {
+				if (fdc_req.write) {
+					memcpy(p, fdc_async_buf, SEC_SZ);
+					tc_flush_queue();
+				} else {
+					/* into the memory bank selected */
+					/* when the command was issued, */
+					/* the ROM page is write protected */
+					addr = fdc_req.addr;
+					for (i = 0; i < SEC_SZ && addr < 0xff00;
+					     i++, addr++)
+						*bank_addr(fdc_req.bank,
+							   addr) = *p++;
+				}
+			}
+			fdc_req.stat = stat;
+			__dmb();
+			fdc_async_state = FDC_ASYNC_DONE;
+			__dmb();
+			fdc_async_int();
+			__sev();
+		}
+		if (best_effort_wfe_or_timeout(until))
+			break;
+	}
+}
+
+void fdc_ext_out(BYTE data)
+{
+	BYTE cmd[5];
+	WORD addr;
+	register int i;
+
+	sio_not_idle();
+
+	switch (fdc_state) {
+	case 1:
+		fdc_cmd_addr = data;
+		fdc_state++;
+		break;
+	case 2:
+		fdc_cmd_addr |= data << 8;
+		fdc_state = 0;
+		break;
+	default:
+		switch (data & 0xf0) {
+		case 0x10:
+			fdc_state = 1;
+			break;
+		case 0x30:
+		case 0x50:
+			wait_disks();
+			for (i = 0; i < 5; i++)
+				cmd[i] = dma_read(fdc_cmd_addr + i);
+			addr = cmd[FDCMD_DMAL] | (cmd[FDCMD_DMAH] << 8);
+			if ((data & 0xf0) == 0x30)
+				fdc_ext_stat = read_secs(data & 0x0f,
+					cmd[FDCMD_TRK], cmd[FDCMD_SEC],
+					cmd[FDCMD_CNT], addr);
+			else
+				fdc_ext_stat = write_secs(data & 0x0f,
+					cmd[FDCMD_TRK], cmd[FDCMD_SEC],
+					cmd[FDCMD_CNT], addr);
+			fdc_ext = true;
+			return;
+		case 0x60:
+			fdc_int = (data & 0x08) != 0;
+			fdc_int_data = 0xc7 | ((data & 0x07) << 3);
+			fdc_ext_stat = FDC_STAT_OK;
+			fdc_ext = true;
+			return;
+		case 0x70:
+#ifdef RAMDISK
+			fdc_ext_stat = save_ramdisk();
+#else
+			fdc_ext_stat = FDC_STAT_DISK;
+#endif
+			fdc_ext = true;
+			return;
+		case 0x80:
+			fdc_ext_stat = discard_overlay(data & 0x0f);
+			fdc_ext = true;
+			return;
+		case 0xa0:
+		case 0xc0:
+			fdc_async_wait();
+			fdc_async_queue(data & 0x0f, (data & 0xf0) == 0xc0);
+			fdc_ext = true;
+			return;
+		default:
+			/* the SD-FDC waits for read-ahead itself if needed */
+			fdc_async_wait();
+			break;
+		}
+	}
+
+	fdc_ext = false;
+	fdc_out(data);
+}
+
+BYTE fdc_ext_in(void)
+{
+	if (fdc_async_state == FDC_ASYNC_DONE)
+		fdc_async_finish();
+	if (fdc_ext)
+		return fdc_ext_stat;
+	else
+		return fdc_in();
+}
+
 /*
  * get FDC command from CPU memory
  */
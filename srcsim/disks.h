@@ -16,23 +16,65 @@
 #include "sim.h"
 #include "simdefs.h"
 
+#include "pico/time.h"
+
 #include "ff.h"
 
 #define NUMDISK	4	/* number of disk drives */
+#if PICO_RP2350
+#define RAMDISK	NUMDISK	/* drive number of the RAM disk, needs 250 KB */
+#endif
 #define DISKLEN	22	/* path length for disk drives /DISKS80/filename.DSK */
+#define DSK_SYNC_WRITES 32 /* sync image file after this many sector writes */
+#define CLMT_SIZE 32	/* size of cluster link map table per disk drive */
+#define TCACHE_NUM NUMDISK /* number of tracks in the track cache */
+#define TCACHE_IDLE_MS 500 /* write back track cache after idle time */
+#define DSK_PREFETCH 1	/* tracks to read ahead for sequential reads, 0 = off */
+
+/* offsets in the FDC command bytes */
+#define FDCMD_TRK	0	/* track */
+#define FDCMD_SEC	1	/* sector */
+#define FDCMD_DMAL	2	/* DMA address low */
+#define FDCMD_DMAH	3	/* DMA address high */
+#define FDCMD_CNT	4	/* sector count for multi sector commands */
+
+#define FDC_STAT_BUSY	0x80	/* asynchronous command not finished yet */
 
 extern FIL sd_file;
 extern FRESULT sd_res;
 extern char disks[NUMDISK][DISKLEN];
+extern bool dsk_overlay[NUMDISK];
+extern bool dsk_wprot[NUMDISK];
+#ifdef RAMDISK
+extern char ramdisk_img[DISKLEN];
+#endif
 
 extern void init_disks(void), exit_disks(void);
 extern void list_files(const char *dir, const char *ext);
 extern bool load_file(const char *name);
 extern void check_disks(void);
 extern void mount_disk(int drive, const char *name);
+extern void unmount_disk(int drive);
+extern void sync_disks(void);
+extern void idle_disks(void);
+extern void report_disk_stats(void);
+extern void set_overlay(int drive, bool on);
+extern BYTE discard_overlay(int drive);
+#ifdef RAMDISK
+extern void load_ramdisk(void);
+extern BYTE save_ramdisk(void);
+extern void mount_ramdisk(const char *name);
+#endif
+extern void wait_disks(void);
 
 extern BYTE read_sec(int drive, int track, int sector, WORD addr);
 extern BYTE write_sec(int drive, int track, int sector, WORD addr);
+extern BYTE read_secs(int drive, int track, int sector, int count, WORD addr);
+extern BYTE write_secs(int drive, int track, int sector, int count,
+		       WORD addr);
+extern BYTE fdc_ext_in(void);
+extern void fdc_ext_out(BYTE data);
+extern void fdc_async_work(absolute_time_t until);
 extern void get_fdccmd(BYTE *cmd, WORD addr);
 
 #endif /* !DISK_INC */
@@ -0,0 +1,434 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements a hard disk controller for large disk
+ * images on the MicroSD with 512 byte sectors.
+ *
+ * I/O port 8 write, bits 4-7 command, bits 0-3 drive:
+ * 1 = set address of the command bytes, LSB and MSB follow
+ * 2 = read sector
+ * 3 = get number of tracks of the disk image
+ * 4 = write sector
+ *
+ * The command bytes are track low, sector, DMA address low,
+ * DMA address high and track high, so that they can be shared
+ * with the SD-FDC. Sectors are counted from 1. Command 3 stores
+ * the number of tracks in the track bytes. Reading port 8 returns
+ * the status of the last command, with the codes of the SD-FDC.
+ *
+ * Sector size is the same as the MicroSD block size and disk images
+ * are cluster aligned, so each sector read or write is a transfer
+ * of a single block.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 wait for asynchronous FDC commands
+ * 16-OCT-2026 sync written images when idle, read only images
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "pico/time.h"
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+#include "simmem.h"
+#include "simio.h"
+
+#include "ff.h"
+#include "f_util.h"
+
+#include "sd-fdc.h"
+#include "disks.h"
+#include "hdc.h"
+#include "draw.h"
+#include "lcd.h"
+
+char hdisks[NUMHDISK][HDISKLEN]; /* path name for hard disk images */
+bool hd_wprot[NUMHDISK];	/* image could only be opened read only */
+
+/* hard disk image files, kept open while the disk is mounted */
+static FIL hd_file[NUMHDISK];
+static bool hd_open[NUMHDISK];
+static int hd_tracks[NUMHDISK];	/* number of tracks of the image */
+static bool hd_dirty[NUMHDISK];	/* image written since the last sync */
+static uint64_t hd_last_io;	/* time of last hard disk I/O */
+
+/* cluster link map tables for fast seeks in the disk image files */
+static DWORD hd_clmt[NUMHDISK][HD_CLMT_SIZE];
+
+/* buffer for sectors crossing the bank boundary */
+static unsigned char __aligned(4) hd_buf[HD_SEC_SZ];
+
+static WORD hdc_cmd_addr;	/* address of the command bytes */
+static int hdc_state;		/* 1,2 = LSB/MSB of address follows */
+static BYTE hdc_stat;		/* status of the last command */
+
+/*
+ * open the disk image file of hard disk 'drive', if not already open
+ */
+static FRESULT open_hdisk(int drive)
+{
+	FRESULT res = FR_OK;
+	FSIZE_t size;
+
+	if (!hd_open[drive]) {
+		hd_wprot[drive] = false;
+		res = f_open(&hd_file[drive], hdisks[drive],
+			     FA_READ | FA_WRITE);
+		/* read only image or card, or image open in another */
+		/* drive, use it write protected */
+		if (res == FR_DENIED || res == FR_WRITE_PROTECTED ||
+		    res == FR_LOCKED) {
+			res = f_open(&hd_file[drive], hdisks[drive], FA_READ);
+			hd_wprot[drive] = (res == FR_OK);
+		}
+		if (res == FR_OK) {
+			/* the image must have whole tracks within limits */
+			size = f_size(&hd_file[drive]);
+			if (size % (HD_SPT * HD_SEC_SZ) != 0 ||
+			    size < (FSIZE_t) HD_MINTRK * HD_SPT * HD_SEC_SZ ||
+			    size > (FSIZE_t) HD_MAXTRK * HD_SPT * HD_SEC_SZ) {
+				f_close(&hd_file[drive]);
+				return FR_INVALID_OBJECT;
+			}
+			hd_tracks[drive] = size / (HD_SPT * HD_SEC_SZ);
+			hd_open[drive] = true;
+			hd_dirty[drive] = false;
+
+			/* create the cluster link map, if the image is too */
+			/* fragmented for the table use normal seeks */
+			hd_file[drive].cltbl = hd_clmt[drive];
+			hd_clmt[drive][0] = HD_CLMT_SIZE;
+			if (f_lseek(&hd_file[drive], CREATE_LINKMAP) != FR_OK)
+				hd_file[drive].cltbl = NULL;
+		}
+	}
+	return res;
+}
+
+/*
+ * close the disk image file of hard disk 'drive'
+ */
+static void close_hdisk(int drive)
+{
+	if (hd_open[drive]) {
+		f_close(&hd_file[drive]);
+		hd_open[drive] = false;
+	}
+}
+
+/*
+ * close all hard disk image files, must be done
+ * before the MicroSD is unmounted
+ */
+void exit_hdisks(void)
+{
+	register int i;
+
+	for (i = 0; i < NUMHDISK; i++)
+		close_hdisk(i);
+}
+
+/*
+ * check that all hard disks refer to existing and usable files
+ */
+void check_hdisks(void)
+{
+	FRESULT res;
+	int i, n = 0;
+
+	for (i = 0; i < NUMHDISK; i++) {
+		if (hdisks[i][0]) {
+			res = open_hdisk(i);
+			if (res == FR_NO_FILE || res == FR_NO_PATH)
+				printf("Hard disk image \"%s\" no longer "
+				       "exists.\n", hdisks[i]);
+			else if (res == FR_INVALID_OBJECT)
+				printf("Hard disk image \"%s\" has an invalid "
+				       "size.\n", hdisks[i]);
+			else if (res != FR_OK)
+				printf("Can't open hard disk image \"%s\": "
+				       "%s (%d)\n", hdisks[i],
+				       FRESULT_str(res), res);
+			if (res != FR_OK) {
+				hdisks[i][0] = '\0';
+				n++;
+			}
+		}
+	}
+	if (n > 0)
+		putchar('\n');
+}
+
+/*
+ * flush pending writes of all written hard disk image files
+ */
+void sync_hdisks(void)
+{
+	register int i;
+
+	for (i = 0; i < NUMHDISK; i++)
+		if (hd_open[i] && hd_dirty[i] &&
+		    f_sync(&hd_file[i]) == FR_OK)
+			hd_dirty[i] = false;
+}
+
+/*
+ * sync the written hard disk image files, if there was no hard
+ * disk I/O for TCACHE_IDLE_MS, called from idle_disks()
+ */
+void idle_hdisks(void)
+{
+	register int i;
+
+	if ((time_us_64() - hd_last_io) < TCACHE_IDLE_MS * 1000)
+		return;
+	for (i = 0; i < NUMHDISK; i++)
+		if (hd_dirty[i]) {
+			/* FatFS is not reentrant */
+			wait_disks();
+			sync_hdisks();
+			break;
+		}
+}
+
+/*
+ * mount a hard disk image 'name' on hard disk 'drive'
+ */
+void mount_hdisk(int drive, const char *name)
+{
+	char SFN[HDISKLEN];
+	FRESULT res;
+	int i;
+
+	strcpy(SFN, "/DISKS80/");
+	strcat(SFN, name);
+	strcat(SFN, ".HDD");
+
+	for (i = 0; i < NUMHDISK; i++) {
+		if (i != drive && strcmp(hdisks[i], SFN) == 0) {
+			puts("Disk already mounted\n");
+			return;
+		}
+	}
+
+	/* close the image currently in the drive */
+	wait_disks();
+	close_hdisk(drive);
+
+	/* try to open file */
+	strcpy(hdisks[drive], SFN);
+	res = open_hdisk(drive);
+	if (res != FR_OK) {
+		hdisks[drive][0] = '\0';
+		if (res == FR_INVALID_OBJECT)
+			printf("Image size must be %d - %d KB in whole "
+			       "tracks\n\n", HD_MINTRK * HD_SPT / 2,
+			       HD_MAXTRK * HD_SPT / 2);
+		else if (res == FR_NO_FILE || res == FR_NO_PATH)
+			puts("File not found\n");
+		else
+			printf("Can't open disk image: %s (%d)\n\n",
+			       FRESULT_str(res), res);
+		return;
+	}
+	if (hd_wprot[drive])
+		puts("Disk image is read only, drive is write protected");
+
+	putchar('\n');
+}
+
+/*
+ * remove the hard disk image from hard disk 'drive'
+ */
+void unmount_hdisk(int drive)
+{
+	wait_disks();
+	close_hdisk(drive);
+	hdisks[drive][0] = '\0';
+}
+
+/*
+ * prepare I/O for sector read and write routines
+ */
+static BYTE prep_hd_io(int drive, int track, int sector, WORD addr)
+{
+	FSIZE_t pos;
+
+	/* check if drive in range */
+	if ((drive < 0) || (drive >= NUMHDISK))
+		return FDC_STAT_DISK;
+
+	/* check if disk in drive */
+	if (!strlen(hdisks[drive]))
+		return FDC_STAT_NODISK;
+
+	/* open file with the disk image, if not done yet */
+	if (open_hdisk(drive) != FR_OK)
+		return FDC_STAT_NODISK;
+
+	/* check if track and sector in range */
+	if (track >= hd_tracks[drive])
+		return FDC_STAT_TRACK;
+	if ((sector < 1) || (sector > HD_SPT))
+		return FDC_STAT_SEC;
+
+	/* check if DMA address in range */
+	if ((unsigned int) addr + HD_SEC_SZ > 0xff00)
+		return FDC_STAT_DMAADR;
+
+	/* seek to the sector */
+	pos = (((FSIZE_t) track * HD_SPT) + sector - 1) * HD_SEC_SZ;
+	if (f_lseek(&hd_file[drive], pos) != FR_OK)
+		return FDC_STAT_SEEK;
+
+	return FDC_STAT_OK;
+}
+
+/*
+ * read from hard disk a sector on track into memory @ addr
+ */
+static BYTE read_hd_sec(int drive, int track, int sector, WORD addr)
+{
+	BYTE stat;
+	unsigned int br;
+	register BYTE *m;
+	register int i;
+
+	led_color = (led_color & ~C_GREEN) | C_GREEN;
+
+	if ((stat = prep_hd_io(drive, track, sector, addr)) == FDC_STAT_OK) {
+		hd_last_io = time_us_64();
+		if ((m = dma_ptr(addr, HD_SEC_SZ)) != NULL) {
+			/* read the block directly into memory */
+			if (f_read(&hd_file[drive], m, HD_SEC_SZ, &br) != FR_OK
+			    || br < HD_SEC_SZ)
+				stat = FDC_STAT_READ;
+		} else {
+			/* sector crosses banks */
+			if (f_read(&hd_file[drive], &hd_buf[0], HD_SEC_SZ,
+				   &br) != FR_OK || br < HD_SEC_SZ)
+				stat = FDC_STAT_READ;
+			else
+				for (i = 0; i < HD_SEC_SZ; i++)
+					dma_write(addr + i, hd_buf[i]);
+		}
+	}
+
+	led_color &= ~C_GREEN;
+
+	return stat;
+}
+
+/*
+ * write to hard disk a sector on track from memory @ addr
+ */
+static BYTE write_hd_sec(int drive, int track, int sector, WORD addr)
+{
+	BYTE stat;
+	unsigned int br;
+	register BYTE *m;
+	register int i;
+
+	led_color = (led_color & ~C_RED) | C_RED;
+
+	if ((stat = prep_hd_io(drive, track, sector, addr)) == FDC_STAT_OK &&
+	    hd_wprot[drive])
+		stat = FDC_STAT_WRITE;
+	if (stat == FDC_STAT_OK) {
+		hd_last_io = time_us_64();
+		hd_dirty[drive] = true;
+		if ((m = dma_ptr(addr, HD_SEC_SZ)) == NULL) {
+			/* sector crosses banks */
+			for (i = 0; i < HD_SEC_SZ; i++)
+				hd_buf[i] = dma_read(addr + i);
+			m = &hd_buf[0];
+		}
+		if (f_write(&hd_file[drive], m, HD_SEC_SZ, &br) != FR_OK
+		    || br < HD_SEC_SZ)
+			stat = FDC_STAT_WRITE;
+	}
+
+	led_color &= ~C_RED;
+
+	return stat;
+}
+
+/*
+ * I/O handler for HDC port write
+ */
+void hdc_out(BYTE data)
+{
+	BYTE cmd[5];
+	int drive = data & 0x0f;
+	register int i;
+
+	sio_not_idle();
+
+	switch (hdc_state) {
+	case 1:
+		hdc_cmd_addr = data;
+		hdc_state++;
+		return;
+	case 2:
+		hdc_cmd_addr |= data << 8;
+		hdc_state = 0;
+		return;
+	default:
+		break;
+	}
+
+	/* FatFS is not reentrant, wait for asynchronous FDC commands */
+	wait_disks();
+
+	switch (data & 0xf0) {
+	case 0x10:
+		hdc_state = 1;
+		break;
+	case 0x20:
+	case 0x40:
+		for (i = 0; i < 5; i++)
+			cmd[i] = dma_read(hdc_cmd_addr + i);
+		if ((data & 0xf0) == 0x20)
+			hdc_stat = read_hd_sec(drive,
+				cmd[HDCMD_TRK] | (cmd[HDCMD_TRKH] << 8),
+				cmd[HDCMD_SEC],
+				cmd[HDCMD_DMAL] | (cmd[HDCMD_DMAH] << 8));
+		else
+			hdc_stat = write_hd_sec(drive,
+				cmd[HDCMD_TRK] | (cmd[HDCMD_TRKH] << 8),
+				cmd[HDCMD_SEC],
+				cmd[HDCMD_DMAL] | (cmd[HDCMD_DMAH] << 8));
+		break;
+	case 0x30:
+		if (drive >= NUMHDISK)
+			hdc_stat = FDC_STAT_DISK;
+		else if (!strlen(hdisks[drive]) ||
+			 open_hdisk(drive) != FR_OK)
+			hdc_stat = FDC_STAT_NODISK;
+		else {
+			dma_write(hdc_cmd_addr + HDCMD_TRK,
+				  hd_tracks[drive] & 0xff);
+			dma_write(hdc_cmd_addr + HDCMD_TRKH,
+				  hd_tracks[drive] >> 8);
+			hdc_stat = FDC_STAT_OK;
+		}
+		break;
+	default:
+		hdc_stat = FDC_STAT_DISK;
+		break;
+	}
+}
+
+/*
+ * I/O handler for HDC port read
+ */
+BYTE hdc_in(void)
+{
+	return hdc_stat;
+}
@@ -0,0 +1,48 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements a hard disk controller for large disk
+ * images on the MicroSD with 512 byte sectors.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 sync written images when idle, read only images
+ */
+
+#ifndef HDC_INC
+#define HDC_INC
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define NUMHDISK	2	/* number of hard disk drives */
+#define HDISKLEN	22	/* path length for hard disks /DISKS80/filename.HDD */
+#define HD_SEC_SZ	512	/* sector size, same as a MicroSD block */
+#define HD_SPT		32	/* sectors per track */
+#define HD_MINTRK	256	/* minimum number of tracks, 4 MB image */
+#define HD_MAXTRK	512	/* maximum number of tracks, 8 MB image */
+#define HD_CLMT_SIZE	64	/* size of cluster link map table per drive */
+
+/* offsets in the HDC command bytes */
+#define HDCMD_TRK	0	/* track low */
+#define HDCMD_SEC	1	/* sector */
+#define HDCMD_DMAL	2	/* DMA address low */
+#define HDCMD_DMAH	3	/* DMA address high */
+#define HDCMD_TRKH	4	/* track high */
+
+extern char hdisks[NUMHDISK][HDISKLEN];
+extern bool hd_wprot[NUMHDISK];
+
+extern void exit_hdisks(void);
+extern void check_hdisks(void);
+extern void sync_hdisks(void);
+extern void idle_hdisks(void);
+extern void mount_hdisk(int drive, const char *name);
+extern void unmount_hdisk(int drive);
+
+extern BYTE hdc_in(void);
+extern void hdc_out(BYTE data);
+
+#endif /* !HDC_INC */
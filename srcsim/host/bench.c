@@ -0,0 +1,206 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module measures the speed of the CPU emulation for benchmarks.
+ * A run of the CPU is measured from start to stop, the results are
+ * appended as one line to a CSV file:
+ *
+ * name		name of the benchmark, given with option -n
+ * cpu		Z80 or 8080, the CPU when the run was started
+ * stop		why the CPU stopped: halt, iohalt, user or error
+ * tstates	executed T-states
+ * instr	executed instructions (opcode fetches), only with WANT_ICNT
+ * cpu_s	CPU time of the thread running the emulation in seconds
+ * wall_s	elapsed time in seconds
+ * mips		million instructions per CPU second, only with WANT_ICNT
+ * tstates_s	T-states per CPU second
+ * cyc_instr	host cycles per instruction, only with WANT_ICNT
+ * cyc_src	source of the host cycles: perf (hardware counter),
+ *		tsc (x86 time stamp counter) or none
+ *
+ * Rates are based on the CPU time, so that they don't depend
+ * on the load of the host. Counting the instructions needs the
+ * CPU bus status, which slows down the memory reads, so without
+ * WANT_ICNT the CPU runs like in the firmware and the instruction
+ * columns are 0.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 instruction count optional
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+#include "simmem.h"
+
+#include "host.h"
+
+#define BENCH_HEADER "name,cpu,stop,tstates,instr,cpu_s,wall_s,mips," \
+		     "tstates_s,cyc_instr,cyc_src\n"
+
+const char *host_bench_file;	/* CSV file for the results */
+const char *host_bench_name = "run"; /* name of the benchmark */
+
+static int start_cpu;		/* CPU at the start of the run */
+static Tstates_t start_T;	/* T-states at the start */
+#ifdef WANT_ICNT
+static uint64_t start_icount;	/* instructions at the start */
+#endif
+static uint64_t start_cycles;	/* host cycles at the start */
+static struct timespec start_cpu_ts, start_wall_ts;
+
+static int perf_fd = -1;	/* hardware cycle counter of the thread */
+
+/*
+ * open the hardware cycle counter for the calling thread,
+ * user mode only, so that it works with restricted perf access
+ */
+static void open_cycles(void)
+{
+#ifdef __linux__
+	struct perf_event_attr pe;
+
+	memset(&pe, 0, sizeof(pe));
+	pe.type = PERF_TYPE_HARDWARE;
+	pe.size = sizeof(pe);
+	pe.config = PERF_COUNT_HW_CPU_CYCLES;
+	pe.disabled = 1;
+	pe.exclude_kernel = 1;
+	pe.exclude_hv = 1;
+	perf_fd = syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0);
+	if (perf_fd >= 0) {
+		ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+}
+
+static const char *cycles_source(void)
+{
+	if (perf_fd >= 0)
+		return "perf";
+#if defined(__x86_64__) || defined(__i386__)
+	return "tsc";
+#else
+	return "none";
+#endif
+}
+
+static uint64_t read_cycles(void)
+{
+	uint64_t c;
+
+	if (perf_fd >= 0 && read(perf_fd, &c, sizeof(c)) == sizeof(c))
+		return c;
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static double ts_diff(const struct timespec *t0, const struct timespec *t1)
+{
+	return (t1->tv_sec - t0->tv_sec) + (t1->tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+/*
+ * called by the thread of the CPU emulation before run_cpu()
+ */
+void host_bench_start(void)
+{
+	if (host_bench_file == NULL)
+		return;
+
+	if (perf_fd < 0)
+		open_cycles();
+
+	start_cpu = cpu;
+	start_T = T;
+#ifdef WANT_ICNT
+	start_icount = icount;
+#endif
+	clock_gettime(CLOCK_MONOTONIC, &start_wall_ts);
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start_cpu_ts);
+	start_cycles = read_cycles();
+}
+
+/*
+ * called by the thread of the CPU emulation after run_cpu(),
+ * appends the results to the CSV file
+ */
+void host_bench_stop(void)
+{
+	struct timespec cpu_ts, wall_ts;
+	uint64_t cycles, instr;
+	Tstates_t tstates;
+	double cpu_s, wall_s;
+	const char *stop;
+	FILE *fp;
+
+	if (host_bench_file == NULL)
+		return;
+
+	cycles = read_cycles() - start_cycles;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_ts);
+	clock_gettime(CLOCK_MONOTONIC, &wall_ts);
+	tstates = T - start_T;
+#ifdef WANT_ICNT
+	instr = icount - start_icount;
+#else
+	instr = 0;
+#endif
+	cpu_s = ts_diff(&start_cpu_ts, &cpu_ts);
+	wall_s = ts_diff(&start_wall_ts, &wall_ts);
+
+	switch (cpu_error) {
+	case NONE:
+	case USERINT:
+		stop = "user";
+		break;
+	case OPHALT:
+		stop = "halt";
+		break;
+	case IOHALT:
+		stop = "iohalt";
+		break;
+	default:
+		stop = "error";
+		break;
+	}
+
+	if ((fp = fopen(host_bench_file, "a")) == NULL) {
+		perror(host_bench_file);
+		return;
+	}
+	fseek(fp, 0, SEEK_END);
+	if (ftell(fp) == 0)
+		fputs(BENCH_HEADER, fp);
+	fprintf(fp, "%s,%s,%s,%" PRIu64 ",%" PRIu64 ",%.3f,%.3f,%.3f,%.0f,"
+		"%.2f,%s\n", host_bench_name,
+		start_cpu == I8080 ? "8080" : "Z80", stop, tstates, instr,
+		cpu_s, wall_s, cpu_s > 0 ? instr / cpu_s / 1e6 : 0.0,
+		cpu_s > 0 ? tstates / cpu_s : 0.0,
+		instr > 0 && cycles > 0 ? (double) cycles / instr : 0.0,
+		cycles > 0 ? cycles_source() : "none");
+	fclose(fp);
+}
@@ -0,0 +1,113 @@
+#!/bin/bash
+# Benchmark suite for the host build of the emulation.
+#
+# Runs a set of workloads with both CPUs at unlimited speed and writes
+# the results as CSV (see bench.c for the columns). With a baseline
+# file from an earlier run, every workload that lost more than the
+# given percentage of its T-states per second is reported and the
+# script fails. Build without HOST_ICNT for the benchmarks, the
+# instruction counters slow down the CPU emulation.
+#
+# usage: bench.sh [-x picosim-host] [-o results.csv] [-c baseline.csv]
+#                 [-p percent]
+
+BIN=./picosim-host
+OUT=bench.csv
+BASE=
+PCT=10
+
+while getopts "x:o:c:p:" opt
+do
+	case $opt in
+	x) BIN=$OPTARG ;;
+	o) OUT=$OPTARG ;;
+	c) BASE=$OPTARG ;;
+	p) PCT=$OPTARG ;;
+	*) echo "usage: $0 [-x picosim-host] [-o results.csv]" \
+		"[-c baseline.csv] [-p percent]" >&2
+	   exit 2 ;;
+	esac
+done
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+TOP=$HERE/../../..
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# MicroSD image with the example programs and CP/M 2.2
+mkdir -p "$WORK"/sd/CODE80 "$WORK"/sd/DISKS80 "$WORK"/sd/CONF80
+cp "$TOP"/src-examples/*.bin "$WORK"/sd/CODE80
+cp "$TOP"/disks/cpm22.dsk "$WORK"/sd/DISKS80
+"$BIN" -i "$WORK"/sd.img -m "$WORK"/sd >/dev/null || exit 2
+
+rm -f "$OUT"
+FAILED=0
+
+# run name cpu seconds stop: run a workload with the commands for the
+# configuration dialog and the console input from stdin, on a fresh
+# copy of the MicroSD image, and check why the CPU stopped
+run()
+{
+	echo "$1 on $2"
+	cp "$WORK"/sd.img "$WORK"/run.img
+	{
+		[ "$2" = 8080 ] && printf 'c'
+		printf 's0\n'
+		cat
+	} | "$BIN" -h -i "$WORK"/run.img -t "$3" -b "$OUT" -n "$1" \
+		>"$WORK/$1-$2.log"
+	if [ "$(tail -n 1 "$OUT" | cut -d, -f3)" != "$4" ]; then
+		echo "$1 on $2 didn't complete, console output:"
+		tail -n 20 "$WORK/$1-$2.log"
+		FAILED=1
+	fi
+}
+
+# 8080 CPU diagnostic, switches to the 8080 itself
+printf 'rTEST8080\ng' | run test8080 8080 60 halt
+
+for cpu in 8080 Z80
+do
+	# Game of Life on the Dazzler, a few cells and start
+	printf 'rLIFE\ng\n\001\011\001\011\001\017\001\004' |
+		run life $cpu 10 user
+
+	# MITS 8K BASIC with a sieve, the program halts the machine
+	{
+		printf 'rBAS8K40\ng\n\nY\n'
+		cat "$HERE"/sieve.bas
+	} | run basic $cpu 120 iohalt
+
+	# boot CP/M 2.2, assemble the BIOS and halt the machine with
+	# a small program entered with DDT
+	printf '0CPM22\ng%s' 'ASM BIOS
+DDT
+A100
+MVI A,AA
+OUT A0
+MVI A,80
+OUT A0
+
+.
+G100
+' | run cpm $cpu 120 iohalt
+done
+
+column -s, -t "$OUT" 2>/dev/null || cat "$OUT"
+
+if [ -n "$BASE" ]; then
+	awk -F, -v pct="$PCT" '
+		NR == FNR { if (FNR > 1) base[$1 "," $2] = $9; next }
+		FNR > 1 && ($1 "," $2) in base {
+			lim = base[$1 "," $2] * (1 - pct / 100)
+			if ($9 < lim) {
+				printf "REGRESSION %s on %s: %.0f T-states/s, " \
+				       "baseline %.0f\n", $1, $2, $9,
+				       base[$1 "," $2]
+				bad = 1
+			}
+		}
+		END { exit bad }' "$BASE" "$OUT" || FAILED=1
+fi
+
+exit $FAILED
@@ -0,0 +1,259 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Micro-benchmark for the memory access of the emulation, compares
+ * the bank test on every access, like before the page tables, with
+ * the page tables of simmem.h:
+ *
+ * cpu		an instruction loop with a typical 8080 mix of opcode
+ *		fetches, memory reads and writes and stack operations,
+ *		bank 1 selected, in million instructions per second
+ * dma		copies of 128 byte sectors into bank 1, byte by byte
+ *		with the bank test and with dma_ptr() and memcpy(),
+ *		in million sectors per second
+ *
+ * Every case runs a number of times (default 9, or the first
+ * argument), the median, minimum and maximum are shown. The memory
+ * functions are copies of the ones in simmem.h, so that the cases
+ * only differ in the access.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#define _POSIX_C_SOURCE 199309L	/* clock_gettime() */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+
+#define NUMBNK	2
+#define BNKSIZ	49152
+#define NINSTR	100000000	/* instructions per run of the CPU loop */
+#define NSECS	10000000	/* sectors per run of the DMA copy */
+#define MAXRUNS	99
+
+static BYTE bnk0[65536], bnk1[BNKSIZ], rom_discard[256];
+static BYTE *banks[NUMBNK] = { bnk0, bnk1 };
+static BYTE selbnk;
+static BYTE *rd_page[256], *wr_page[256];
+
+/* the front panel LED's, so that the compiler keeps every access */
+static volatile WORD fp_led_address;
+static volatile BYTE fp_led_data;
+
+/*
+ * memory access with the bank test
+ */
+static inline void bank_dma_write(WORD addr, BYTE data)
+{
+	if (selbnk == 0 || addr >= BNKSIZ) {
+		if (addr < 0xff00)
+			bnk0[addr] = data;
+	} else
+		banks[selbnk][addr] = data;
+}
+
+static inline void bank_memwrt(WORD addr, BYTE data)
+{
+	fp_led_address = addr;
+	fp_led_data = data;
+	bank_dma_write(addr, data);
+}
+
+static inline BYTE bank_memrdr(WORD addr)
+{
+	register BYTE data;
+
+	if (selbnk == 0 || addr >= BNKSIZ)
+		data = bnk0[addr];
+	else
+		data = banks[selbnk][addr];
+	fp_led_address = addr;
+	fp_led_data = data;
+	return data;
+}
+
+/*
+ * memory access with the page tables
+ */
+static inline void page_memwrt(WORD addr, BYTE data)
+{
+	fp_led_address = addr;
+	fp_led_data = data;
+	wr_page[addr >> 8][addr & 0xff] = data;
+}
+
+static inline BYTE page_memrdr(WORD addr)
+{
+	register BYTE data;
+
+	data = rd_page[addr >> 8][addr & 0xff];
+	fp_led_address = addr;
+	fp_led_data = data;
+	return data;
+}
+
+static inline BYTE *dma_ptr(WORD addr, unsigned int len)
+{
+	register unsigned int last = addr + len - 1;
+
+	if (last >= 0xff00)
+		return NULL;
+	if (selbnk == 0 || addr >= BNKSIZ)
+		return &bnk0[addr];
+	if (last < BNKSIZ)
+		return &banks[selbnk][addr];
+	return NULL;
+}
+
+/*
+ * the instruction loop, fetch an opcode and do what
+ * its lower bits say
+ */
+#define CPU_LOOP(rd, wr)						\
+	register WORD pc = 0x0100, hl = 0x8000, sp = 0xbf00;		\
+	register BYTE a = 0, op;					\
+	register long n;						\
+									\
+	for (n = 0; n < NINSTR; n++) {					\
+		op = rd(pc++);						\
+		if (pc >= 0x3000)					\
+			pc = 0x0100;					\
+		switch (op & 7) {					\
+		case 0:							\
+		case 1:							\
+		case 2:							\
+			a += op;					\
+			break;						\
+		case 3:							\
+			a += rd(hl++);					\
+			break;						\
+		case 4:							\
+			wr(hl++, a);					\
+			break;						\
+		case 5:							\
+			a ^= rd(pc++);					\
+			break;						\
+		case 6:							\
+			wr(--sp, a);					\
+			wr(--sp, op);					\
+			break;						\
+		case 7:							\
+			a += rd(sp++);					\
+			a += rd(sp++);					\
+			break;						\
+		}							\
+		if (sp < 0xbe00 || sp > 0xbf00)				\
+			sp = 0xbf00;					\
+		if (hl >= 0xe000)					\
+			hl = 0x8000;					\
+	}								\
+	return a
+
+static BYTE cpu_bank(void)
+{
+	CPU_LOOP(bank_memrdr, bank_memwrt);
+}
+
+static BYTE cpu_page(void)
+{
+	CPU_LOOP(page_memrdr, page_memwrt);
+}
+
+static BYTE sec[128];
+
+static BYTE dma_bank(void)
+{
+	register WORD addr = 0x8000;
+	register long n;
+	register int i;
+
+	for (n = 0; n < NSECS; n++) {
+		for (i = 0; i < 128; i++)
+			bank_dma_write(addr + i, sec[i]);
+		addr = addr >= 0xbe00 ? 0x8000 : addr + 128;
+	}
+	return bnk1[0x8000];
+}
+
+static BYTE dma_page(void)
+{
+	register WORD addr = 0x8000;
+	register BYTE *p;
+	register long n;
+
+	for (n = 0; n < NSECS; n++) {
+		if ((p = dma_ptr(addr, 128)) != NULL)
+			memcpy(p, sec, 128);
+		addr = addr >= 0xbe00 ? 0x8000 : addr + 128;
+	}
+	return bnk1[0x8000];
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *) a, y = *(const double *) b;
+
+	return x < y ? -1 : x > y;
+}
+
+/*
+ * run a case 'runs' times and show the median, minimum and
+ * maximum of 'count' divided by the time of a run
+ */
+static void run(const char *name, BYTE (*f)(void), long count, int runs)
+{
+	double rate[MAXRUNS];
+	struct timespec t0, t1;
+	volatile BYTE sink;
+	int i;
+
+	for (i = 0; i < runs; i++) {
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		sink = (*f)();
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		rate[i] = count / ((t1.tv_sec - t0.tv_sec) +
+				   (t1.tv_nsec - t0.tv_nsec) / 1e9) / 1e6;
+	}
+	(void) sink;
+	qsort(rate, runs, sizeof(double), cmp_double);
+	printf("%-12s %8.1f M/s (min %.1f, max %.1f)\n", name,
+	       rate[runs / 2], rate[0], rate[runs - 1]);
+}
+
+int main(int argc, char *argv[])
+{
+	int runs = 9;
+	register int i;
+
+	if (argc > 1 && ((runs = atoi(argv[1])) < 1 || runs > MAXRUNS)) {
+		fprintf(stderr, "usage: %s [runs 1-%d]\n", argv[0], MAXRUNS);
+		return 2;
+	}
+
+	/* bank 1 selected, the ROM page is write protected */
+	selbnk = 1;
+	for (i = 0; i < 256; i++)
+		rd_page[i] = wr_page[i] = (i < BNKSIZ / 256 ? bnk1 : bnk0)
+					  + (i << 8);
+	wr_page[0xff] = rom_discard;
+	for (i = 0; i < BNKSIZ; i++)
+		bnk1[i] = (BYTE) (i * 7);
+	for (i = 0; i < 128; i++)
+		sec[i] = (BYTE) i;
+
+	run("cpu bank", cpu_bank, NINSTR, runs);
+	run("cpu page", cpu_page, NINSTR, runs);
+	run("dma bank", dma_bank, NSECS, runs);
+	run("dma page", dma_page, NSECS, runs);
+
+	return 0;
+}
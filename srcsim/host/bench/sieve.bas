@@ -0,0 +1,15 @@
+10 REM SIEVE OF ERATOSTHENES, 10 PASSES OVER 2000 NUMBERS
+20 DIM F(2000)
+30 FOR L=1 TO 10
+40 C=0
+50 FOR I=2 TO 2000:F(I)=1:NEXT I
+60 FOR I=2 TO 2000
+70 IF F(I)=0 THEN 100
+80 C=C+1
+90 FOR K=I+I TO 2000 STEP I:F(K)=0:NEXT K
+100 NEXT I
+110 PRINT L;C
+120 NEXT L
+130 REM HALT THE EMULATION WITH THE HARDWARE CONTROL PORT
+140 OUT 160,170:OUT 160,128
+RUN
@@ -0,0 +1,98 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * FatFS media access functions for the host build,
+ * the MicroSD is an image file with a FAT file system.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 sd_init_driver()
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "ff.h"
+#include "diskio.h"
+#include "hw_config.h"
+
+#include "host.h"
+
+#define SD_SEC_SZ	512	/* MicroSD block size */
+
+static int sd_fd = -1;
+
+/*
+ * the image file is opened with the first access
+ */
+bool sd_init_driver(void)
+{
+	return true;
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+	if (pdrv != 0)
+		return STA_NOINIT;
+	if (sd_fd < 0)
+		sd_fd = open(host_sd_image, O_RDWR);
+	return (sd_fd < 0) ? STA_NOINIT : 0;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+	return (pdrv != 0 || sd_fd < 0) ? STA_NOINIT : 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count)
+{
+	size_t len = (size_t) count * SD_SEC_SZ;
+
+	if (disk_status(pdrv) != 0)
+		return RES_NOTRDY;
+	if (pread(sd_fd, buff, len, (off_t) sector * SD_SEC_SZ) !=
+	    (ssize_t) len)
+		return RES_ERROR;
+	return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count)
+{
+	size_t len = (size_t) count * SD_SEC_SZ;
+
+	if (disk_status(pdrv) != 0)
+		return RES_NOTRDY;
+	if (pwrite(sd_fd, buff, len, (off_t) sector * SD_SEC_SZ) !=
+	    (ssize_t) len)
+		return RES_ERROR;
+	return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+	struct stat st;
+
+	if (disk_status(pdrv) != 0)
+		return RES_NOTRDY;
+
+	switch (cmd) {
+	case CTRL_SYNC:
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		if (fstat(sd_fd, &st) < 0)
+			return RES_ERROR;
+		*(LBA_t *) buff = st.st_size / SD_SEC_SZ;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *) buff = SD_SEC_SZ;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		*(DWORD *) buff = 1;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
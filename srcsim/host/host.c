@@ -0,0 +1,465 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Main program of the host build, it handles the command line and
+ * substitutes the USB CDC console with stdin/stdout of the process.
+ *
+ * In interactive mode the terminal is switched into raw mode and
+ * Ctrl-] sends a break, which stops the CPU. In headless mode stdin
+ * and stdout can be files or pipes, line feeds in the input are
+ * converted into carriage returns. When the input is exhausted and
+ * the machine waits for a command line, the disks are closed and the
+ * program ends. A time limit stops the CPU like a break.
+ *
+ * With -m the MicroSD image is created from a directory of the host,
+ * which has the directories CODE80, DISKS80 and CONF80 of a MicroSD.
+ *
+ * With -a the second CDC interface is a pseudo terminal, its name is
+ * shown at the start. It is connected while a program has it open.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 options for benchmarks
+ * 16-OCT-2026 chars available callback
+ * 16-OCT-2026 substitute the MSC USB stdio library
+ * 16-OCT-2026 second CDC interface on a pseudo terminal
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <pthread.h>
+
+#include "pico/stdio.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+#include "tusb.h"
+#include "stdio_msc_usb.h"
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+
+#include "disks.h"
+#include "host.h"
+
+#define BREAK_KEY	0x1d	/* Ctrl-] */
+
+const char *host_sd_image = "sdcard.img";
+
+static bool headless;		/* stdin/stdout aren't a terminal */
+static bool tty_raw;		/* terminal is in raw mode */
+static struct termios tty_save;	/* terminal settings to restore */
+
+static int in_char = -1;	/* character read ahead from stdin */
+static bool in_eof;		/* stdin is exhausted */
+static volatile bool host_quit;	/* end at next command line input */
+static int aux_fd = -1;		/* master of the pseudo terminal, or -1 */
+
+static void (*chars_cb)(void *);	/* chars available callback */
+static void *chars_param;
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-h] [-a] [-i image] [-f file] [-t sec] "
+		"[-b file [-n name]]\n"
+		"       %s [-i image] [-s MB] -m dir\n", name, name);
+	fputs("\t-h\theadless, stdin/stdout needn't be a terminal\n"
+	      "\t-a\tsecond CDC interface on a pseudo terminal\n"
+	      "\t-i image\tfile with the MicroSD image (default "
+	      "sdcard.img)\n"
+	      "\t-f file\tdump the LCD frame buffer as PPM into file, at\n"
+	      "\t\tthe end and on SIGUSR1\n"
+	      "\t-t sec\tstop the CPU after sec seconds\n"
+	      "\t-b file\tappend the speed of the CPU runs to CSV file\n"
+	      "\t-n name\tname of the benchmark in the CSV file\n"
+	      "\t-m dir\tcreate the MicroSD image from directory dir\n"
+	      "\t-s MB\tsize of the created image (default 64)\n", stderr);
+	exit(EXIT_FAILURE);
+}
+
+static void tty_restore(void)
+{
+	if (tty_raw)
+		tcsetattr(STDIN_FILENO, TCSAFLUSH, &tty_save);
+}
+
+/*
+ * raw mode of the terminal, output processing stays on
+ * for the line feed to carriage return/line feed conversion
+ */
+static void tty_setup(void)
+{
+	struct termios t;
+
+	if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &tty_save) < 0)
+		return;
+	t = tty_save;
+	t.c_iflag &= ~(BRKINT | ICRNL | INLCR | IGNCR | ISTRIP | IXON);
+	t.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+	t.c_cc[VMIN] = 1;
+	t.c_cc[VTIME] = 0;
+	if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &t) == 0) {
+		tty_raw = true;
+		atexit(tty_restore);
+	}
+}
+
+/*
+ * stop the CPU like with a break from the terminal,
+ * the program ends at the next command line input
+ */
+static void host_stop(void)
+{
+	host_quit = true;
+	tud_cdc_send_break_cb(0, 0);
+}
+
+static void sig_stop(int sig)
+{
+	(void) sig;
+
+	host_stop();
+}
+
+static void sig_dump(int sig)
+{
+	(void) sig;
+
+	host_fb_dump = true;
+}
+
+static void *time_limit(void *arg)
+{
+	sleep((unsigned int) (long) arg);
+	host_stop();
+	return NULL;
+}
+
+/*
+ * end the program, when there is no more input
+ */
+static void __attribute__((noreturn)) host_exit(void)
+{
+	exit_disks();
+	fflush(stdout);
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ * check for input, without waiting for it
+ */
+static bool host_peek(void)
+{
+	struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+	unsigned char c;
+	ssize_t n;
+
+	fflush(stdout);
+	if (in_char >= 0)
+		return true;
+	if (in_eof || poll(&pfd, 1, 0) <= 0)
+		return false;
+
+	if ((n = read(STDIN_FILENO, &c, 1)) <= 0) {
+		if (n == 0 || errno != EINTR)
+			in_eof = true;
+		return false;
+	}
+	if (c == BREAK_KEY && !headless) {
+		tud_cdc_send_break_cb(0, 0);
+		return false;
+	}
+	if (c == '\n' && headless)
+		c = '\r';
+	in_char = c;
+	return true;
+}
+
+/*
+ * getchar() of the machine, waits for input
+ */
+int host_getchar(void)
+{
+	struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+	int c;
+
+	for (;;) {
+		if (host_quit)
+			host_exit();
+		if (host_peek()) {
+			c = in_char;
+			in_char = -1;
+			return c;
+		}
+		if (in_eof)
+			host_exit();
+		poll(&pfd, 1, 100);
+	}
+}
+
+/*
+ * getchar_timeout_us() of the machine, waits for input
+ * until the timeout
+ */
+int getchar_timeout_us(uint32_t timeout_us)
+{
+	struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+	uint64_t until = time_us_64() + timeout_us, now;
+	int c;
+
+	for (;;) {
+		if (host_peek()) {
+			c = in_char;
+			in_char = -1;
+			return c;
+		}
+		now = time_us_64();
+		if (in_eof || now >= until)
+			return PICO_ERROR_TIMEOUT;
+		poll(&pfd, 1, (int) ((until - now + 999) / 1000));
+	}
+}
+
+/*
+ * background task, calls the chars available callback with
+ * interrupts disabled, when there is input
+ */
+static void *usb_task(void *arg)
+{
+	struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+
+	(void) arg;
+
+	for (;;) {
+		/* sleep, if the input is read elsewhere or is held */
+		if (chars_cb == NULL || in_char >= 0 || in_eof)
+			usleep(1000);
+		else
+			poll(&pfd, 1, 1);
+		save_and_disable_interrupts();
+		if (chars_cb != NULL && host_peek())
+			(*chars_cb)(chars_param);
+		restore_interrupts(0);
+	}
+	return NULL;
+}
+
+static void set_chars_available_callback(void (*fn)(void *), void *param)
+{
+	static bool started;
+	pthread_t thread;
+
+	save_and_disable_interrupts();
+	chars_cb = fn;
+	chars_param = param;
+	restore_interrupts(0);
+
+	if (fn != NULL && !started) {
+		if (pthread_create(&thread, NULL, usb_task, NULL) != 0)
+			panic("can't start the USB task");
+		pthread_detach(thread);
+		started = true;
+	}
+}
+
+stdio_driver_t stdio_msc_usb = {
+	.set_chars_available_callback = set_chars_available_callback
+};
+
+bool stdio_init_all(void)
+{
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	return true;
+}
+
+bool tusb_init(void)
+{
+	return true;
+}
+
+bool stdio_msc_usb_init(void)
+{
+	return true;
+}
+
+/*
+ * the CDC interface is always connected
+ */
+bool tud_cdc_connected(void)
+{
+	return true;
+}
+
+/*
+ * input of the SIO receive buffer, takes what stdin has
+ * without waiting
+ */
+int stdio_msc_usb_in_chars_try(char *buf, int length)
+{
+	int n = 0;
+
+	while (n < length && host_peek()) {
+		buf[n++] = (char) in_char;
+		in_char = -1;
+	}
+	return n;
+}
+
+/*
+ * output of the SIO transmit buffer, stdout always takes all of it
+ */
+int stdio_msc_usb_out_chars_try(const char *buf, int length)
+{
+	fwrite(buf, 1, (size_t) length, stdout);
+	fflush(stdout);
+	return length;
+}
+
+/*
+ * the MicroSD image can be accessed on the host, when the
+ * program doesn't run
+ */
+void stdio_msc_usb_do_msc(void)
+{
+	puts("Not available on the host");
+}
+
+/*
+ * open the pseudo terminal for the second CDC interface, raw and
+ * without waiting, like the CDC FIFO
+ */
+static void aux_setup(void)
+{
+	struct termios t;
+
+	if ((aux_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK)) < 0 ||
+	    grantpt(aux_fd) != 0 || unlockpt(aux_fd) != 0) {
+		perror("pseudo terminal");
+		exit(EXIT_FAILURE);
+	}
+	if (tcgetattr(aux_fd, &t) == 0) {
+		cfmakeraw(&t);
+		tcsetattr(aux_fd, TCSANOW, &t);
+	}
+	fprintf(stderr, "second CDC interface on %s\n", ptsname(aux_fd));
+}
+
+/*
+ * the second CDC interface is connected, while the slave of
+ * the pseudo terminal is open
+ */
+bool stdio_msc_usb_aux_connected(void)
+{
+	struct pollfd pfd = { .fd = aux_fd, .events = POLLIN };
+
+	return aux_fd >= 0 && poll(&pfd, 1, 0) >= 0 &&
+	       !(pfd.revents & POLLHUP);
+}
+
+int stdio_msc_usb_aux_in_chars_try(char *buf, int length)
+{
+	ssize_t n;
+
+	if (aux_fd < 0 || (n = read(aux_fd, buf, (size_t) length)) <= 0)
+		return 0;
+	return (int) n;
+}
+
+int stdio_msc_usb_aux_out_chars_try(const char *buf, int length)
+{
+	ssize_t n;
+
+	if (!stdio_msc_usb_aux_connected())
+		return length;		/* discarded */
+	if ((n = write(aux_fd, buf, (size_t) length)) <= 0)
+		return 0;
+	return (int) n;
+}
+
+int main(int argc, char *argv[])
+{
+	struct sigaction sa;
+	pthread_t thread;
+	const char *mkimg_dir = NULL;
+	long limit = 0, size = 64;
+	int c;
+	bool aux = false;
+
+	while ((c = getopt(argc, argv, "hai:f:t:b:n:m:s:")) != -1) {
+		switch (c) {
+		case 'h':
+			headless = true;
+			break;
+		case 'a':
+			aux = true;
+			break;
+		case 'i':
+			host_sd_image = optarg;
+			break;
+		case 'f':
+			host_fb_file = optarg;
+			break;
+		case 't':
+			if ((limit = atol(optarg)) <= 0)
+				usage(argv[0]);
+			break;
+		case 'b':
+			host_bench_file = optarg;
+			break;
+		case 'n':
+			host_bench_name = optarg;
+			break;
+		case 'm':
+			mkimg_dir = optarg;
+			break;
+		case 's':
+			if ((size = atol(optarg)) < 1 || size > 4096)
+				usage(argv[0]);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind != argc)
+		usage(argv[0]);
+
+	if (mkimg_dir != NULL)
+		return host_mkimage(mkimg_dir, size) == 0 ?
+			EXIT_SUCCESS : EXIT_FAILURE;
+
+	if (access(host_sd_image, R_OK | W_OK) != 0) {
+		fprintf(stderr, "%s: can't access MicroSD image %s: %s\n",
+			argv[0], host_sd_image, strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	if (aux)
+		aux_setup();
+	if (!headless)
+		tty_setup();
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = sig_stop;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sa.sa_handler = sig_dump;
+	sigaction(SIGUSR1, &sa, NULL);
+	if (host_fb_file != NULL)
+		atexit(host_dump_fb);
+
+	if (limit > 0) {
+		pthread_create(&thread, NULL, time_limit, (void *) limit);
+		pthread_detach(thread);
+	}
+
+	return picosim_main();
+}
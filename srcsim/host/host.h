@@ -0,0 +1,29 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Interfaces between the modules of the host build.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 benchmark results
+ */
+
+#ifndef HOST_INC
+#define HOST_INC
+
+#include <stdbool.h>
+
+extern const char *host_sd_image;	/* image file with the MicroSD */
+extern const char *host_fb_file;	/* file for frame buffer dumps */
+extern volatile bool host_fb_dump;	/* dump frame buffer requested */
+extern const char *host_bench_file;	/* CSV file for benchmark results */
+extern const char *host_bench_name;	/* name of the benchmark */
+
+extern int picosim_main(void);
+extern void host_dump_fb(void);
+extern int host_mkimage(const char *dir, unsigned int size);
+extern void host_bench_start(void), host_bench_stop(void);
+
+#endif /* !HOST_INC */
@@ -0,0 +1,380 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitutes of the Raspberry Pi Pico SDK functions and of the
+ * libraries for the host build. Core 1 and the alarms are threads,
+ * the events between the cores are a condition variable.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 repeating alarms
+ * 16-OCT-2026 disabling interrupts
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "pico.h"
+#include "pico/time.h"
+#include "pico/multicore.h"
+#include "pico/aon_timer.h"
+#include "hardware/watchdog.h"
+
+#include "ff.h"
+#include "my_rtc.h"
+#include "ds3231.h"
+
+static pthread_mutex_t ev_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ev_cond;
+static bool ev_flag[2];			/* event registers of the cores */
+/* held by the threads substituting interrupt handlers while they run */
+static pthread_mutex_t irq_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread unsigned int core_num;	/* core of the thread */
+
+static pthread_t core1;
+static bool core1_running;
+
+static time_t aon_offset;		/* always-on timer - host clock */
+static time_t rtc_offset;		/* DS3231 RTC - host clock */
+
+static uint64_t start_us;		/* host clock at "boot" */
+
+static uint64_t host_clock_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void __attribute__((constructor)) host_init(void)
+{
+	pthread_condattr_t attr;
+
+	/* the timeouts of the events are on the monotonic clock */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&ev_cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	start_us = host_clock_us();
+}
+
+uint64_t time_us_64(void)
+{
+	return host_clock_us() - start_us;
+}
+
+void sleep_us(uint64_t us)
+{
+	struct timespec ts;
+
+	fflush(stdout);
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000;
+	nanosleep(&ts, NULL);
+}
+
+void sleep_ms(uint32_t ms)
+{
+	sleep_us((uint64_t) ms * 1000);
+}
+
+unsigned int get_core_num(void)
+{
+	return core_num;
+}
+
+/*
+ * wait for an event, returns if the timestamp 'until'
+ * (0 for no timeout) is reached
+ */
+static bool wait_event(absolute_time_t until)
+{
+	struct timespec ts;
+	uint64_t t;
+	bool reached = false;
+
+	pthread_mutex_lock(&ev_mutex);
+	while (!ev_flag[core_num]) {
+		/* wake up at least every ms, like the cores with interrupts */
+		t = time_us_64();
+		if (until != 0 && t >= until) {
+			reached = true;
+			break;
+		}
+		if (until == 0 || until - t > 1000)
+			t += 1000;
+		else
+			t = until;
+		t += start_us;
+		ts.tv_sec = t / 1000000;
+		ts.tv_nsec = (t % 1000000) * 1000;
+		if (pthread_cond_timedwait(&ev_cond, &ev_mutex, &ts) != 0 &&
+		    until == 0)
+			break;
+	}
+	ev_flag[core_num] = false;
+	pthread_mutex_unlock(&ev_mutex);
+	return reached;
+}
+
+void host_wfe(void)
+{
+	wait_event(0);
+}
+
+void host_sev(void)
+{
+	pthread_mutex_lock(&ev_mutex);
+	ev_flag[0] = ev_flag[1] = true;
+	pthread_cond_broadcast(&ev_cond);
+	pthread_mutex_unlock(&ev_mutex);
+}
+
+void host_wfi(void)
+{
+	usleep(1000);
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp)
+{
+	if (time_reached(timeout_timestamp))
+		return true;
+	return wait_event(timeout_timestamp) ||
+		time_reached(timeout_timestamp);
+}
+
+/*
+ * interrupt handlers are threads, which run their callbacks
+ * with interrupts disabled, so this keeps them from running
+ */
+uint32_t save_and_disable_interrupts(void)
+{
+	pthread_mutex_lock(&irq_mutex);
+	return 0;
+}
+
+void restore_interrupts(uint32_t status)
+{
+	(void) status;
+
+	pthread_mutex_unlock(&irq_mutex);
+}
+
+static void *core1_entry(void *arg)
+{
+	core_num = 1;
+	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
+	((void (*)(void)) arg)();
+	return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void))
+{
+	if (pthread_create(&core1, NULL, core1_entry, (void *) entry) != 0)
+		panic("can't start core 1");
+	core1_running = true;
+}
+
+void multicore_reset_core1(void)
+{
+	if (core1_running) {
+		pthread_cancel(core1);
+		pthread_join(core1, NULL);
+		core1_running = false;
+	}
+}
+
+/*
+ * alarms are threads, which sleep until the alarm is due,
+ * like with the SDK a callback returning a value other than 0
+ * reschedules the alarm in that many microseconds
+ */
+typedef struct {
+	alarm_id_t id;
+	uint64_t us;
+	alarm_callback_t callback;
+	void *user_data;
+} alarm_t;
+
+/*
+ * sleep until 'us' microseconds since the start of the program
+ */
+static void sleep_until_us(uint64_t us)
+{
+	struct timespec ts;
+
+	us += start_us;
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL)
+	       == EINTR)
+		;
+}
+
+static void *alarm_entry(void *arg)
+{
+	alarm_t *a = arg;
+	uint64_t due = time_us_64() + a->us;
+	int64_t r;
+
+	for (;;) {
+		sleep_until_us(due);
+		if ((r = (*a->callback)(a->id, a->user_data)) == 0)
+			break;
+		/* > 0 relative to the time the alarm was due, */
+		/* < 0 relative to the time of the callback */
+		due = r > 0 ? due + r : time_us_64() - r;
+	}
+	free(a);
+	return NULL;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback,
+			   void *user_data, bool fire_if_past)
+{
+	static alarm_id_t next_id;
+	pthread_t thread;
+	alarm_t *a;
+
+	(void) fire_if_past;
+
+	if ((a = malloc(sizeof(alarm_t))) == NULL)
+		return -1;
+	a->id = ++next_id;
+	a->us = us;
+	a->callback = callback;
+	a->user_data = user_data;
+	if (pthread_create(&thread, NULL, alarm_entry, a) != 0) {
+		free(a);
+		return -1;
+	}
+	pthread_detach(thread);
+	return a->id;
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback,
+			   void *user_data, bool fire_if_past)
+{
+	return add_alarm_in_us((uint64_t) ms * 1000, callback, user_data,
+			       fire_if_past);
+}
+
+void aon_timer_start(const struct timespec *ts)
+{
+	aon_timer_set_time(ts);
+}
+
+bool aon_timer_set_time(const struct timespec *ts)
+{
+	aon_offset = ts->tv_sec - time(NULL);
+	return true;
+}
+
+bool aon_timer_get_time(struct timespec *ts)
+{
+	ts->tv_sec = time(NULL) + aon_offset;
+	ts->tv_nsec = 0;
+	return true;
+}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms)
+{
+	(void) pc;
+	(void) sp;
+	(void) delay_ms;
+
+	fflush(stdout);
+	exit(EXIT_SUCCESS);
+}
+
+void panic(const char *fmt, ...)
+{
+	va_list ap;
+
+	fflush(stdout);
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fputc('\n', stderr);
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * the DS3231 RTC runs with an offset to the host clock
+ */
+void ds3231_init(i2c_inst_t *i2c_port, uint8_t i2c_sda_pin,
+		 uint8_t i2c_scl_pin, ds3231_rtc_t *rtc)
+{
+	(void) DS3231_MONTHS;
+	(void) DS3231_WDAYS;
+
+	rtc->i2c_port = i2c_port;
+	rtc->i2c_addr = DS3231_I2C_ADDRESS;
+	rtc->i2c_sda_pin = i2c_sda_pin;
+	rtc->i2c_scl_pin = i2c_scl_pin;
+}
+
+void ds3231_get_datetime(ds3231_datetime_t *dt, ds3231_rtc_t *rtc)
+{
+	time_t now = time(NULL) + rtc_offset;
+	struct tm t;
+
+	(void) rtc;
+
+	localtime_r(&now, &t);
+	dt->year = t.tm_year + 1900;
+	dt->month = t.tm_mon + 1;
+	dt->day = t.tm_mday;
+	dt->dotw = t.tm_wday ? t.tm_wday : 7;
+	dt->hour = t.tm_hour;
+	dt->minutes = t.tm_min;
+	dt->seconds = t.tm_sec;
+}
+
+void ds3231_set_datetime(ds3231_datetime_t *dt, ds3231_rtc_t *rtc)
+{
+	struct tm t = { .tm_isdst = -1 };
+
+	(void) rtc;
+
+	t.tm_year = dt->year - 1900;
+	t.tm_mon = dt->month - 1;
+	t.tm_mday = dt->day;
+	t.tm_hour = dt->hour;
+	t.tm_min = dt->minutes;
+	t.tm_sec = dt->seconds;
+	rtc_offset = mktime(&t) - time(NULL);
+}
+
+/*
+ * FatFS RTC, the time stamps come from the always-on timer
+ */
+void time_init(void)
+{
+}
+
+DWORD get_fattime(void)
+{
+	struct timespec ts;
+	struct tm t;
+
+	aon_timer_get_time(&ts);
+	localtime_r(&ts.tv_sec, &t);
+	if (t.tm_year < 80)
+		return 0;
+	return ((DWORD) (t.tm_year - 80) << 25) |
+		((DWORD) (t.tm_mon + 1) << 21) |
+		((DWORD) t.tm_mday << 16) |
+		((DWORD) t.tm_hour << 11) |
+		((DWORD) t.tm_min << 5) |
+		((DWORD) t.tm_sec >> 1);
+}
@@ -0,0 +1,28 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build,
+ * the temperature sensor always reads 27 C.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef HARDWARE_ADC_H
+#define HARDWARE_ADC_H
+
+#include "pico.h"
+
+static inline void adc_init(void) { }
+static inline void adc_set_temp_sensor_enabled(bool enable) { (void) enable; }
+static inline void adc_select_input(unsigned int input) { (void) input; }
+
+/* 0.706 V of the sensor at 27 C */
+static inline uint16_t adc_read(void)
+{
+	return 876;
+}
+
+#endif /* !HARDWARE_ADC_H */
@@ -0,0 +1,45 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build,
+ * the only I2C device is the DS3231 RTC, which answers with the
+ * host clock.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef HARDWARE_I2C_H
+#define HARDWARE_I2C_H
+
+#include "pico.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+#define i2c_default	((i2c_inst_t *) NULL)
+
+static inline int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr,
+				     const uint8_t *src, size_t len,
+				     bool nostop)
+{
+	(void) i2c;
+	(void) addr;
+	(void) src;
+	(void) nostop;
+	return (int) len;
+}
+
+static inline int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr,
+				    uint8_t *dst, size_t len, bool nostop)
+{
+	(void) i2c;
+	(void) addr;
+	(void) nostop;
+	for (size_t i = 0; i < len; i++)
+		dst[i] = 0;
+	return (int) len;
+}
+
+#endif /* !HARDWARE_I2C_H */
@@ -0,0 +1,22 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build,
+ * the barrier and event functions are in pico.h.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 disabling interrupts
+ */
+
+#ifndef HARDWARE_SYNC_H
+#define HARDWARE_SYNC_H
+
+#include "pico.h"
+
+extern uint32_t save_and_disable_interrupts(void);
+extern void restore_interrupts(uint32_t status);
+
+#endif /* !HARDWARE_SYNC_H */
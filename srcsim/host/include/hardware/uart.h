@@ -0,0 +1,34 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build,
+ * there is no UART, the console is the CDC substitute.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef HARDWARE_UART_H
+#define HARDWARE_UART_H
+
+#include "pico.h"
+
+typedef struct uart_inst uart_inst_t;
+
+#define uart_default	((uart_inst_t *) NULL)
+
+static inline bool uart_is_readable(uart_inst_t *uart)
+{
+	(void) uart;
+	return false;
+}
+
+static inline bool uart_is_writable(uart_inst_t *uart)
+{
+	(void) uart;
+	return true;
+}
+
+#endif /* !HARDWARE_UART_H */
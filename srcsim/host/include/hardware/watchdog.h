@@ -0,0 +1,21 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build,
+ * a reboot ends the program.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef HARDWARE_WATCHDOG_H
+#define HARDWARE_WATCHDOG_H
+
+#include "pico.h"
+
+extern void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms)
+	__attribute__((noreturn));
+
+#endif /* !HARDWARE_WATCHDOG_H */
@@ -0,0 +1,43 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the SD card driver configuration for the host build,
+ * the MicroSD is an image file, so the configuration isn't used.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 sd_init_driver()
+ */
+
+#ifndef HW_CONFIG_H
+#define HW_CONFIG_H
+
+#include "pico.h"
+
+#define DMA_IRQ_0	0
+
+typedef enum {
+	SD_IF_NONE,
+	SD_IF_SPI,
+	SD_IF_SDIO
+} sd_if_t;
+
+typedef struct {
+	unsigned int CMD_gpio;
+	unsigned int D0_gpio;
+	unsigned int DMA_IRQ_num;
+	unsigned int baud_rate;
+} sd_sdio_if_t;
+
+typedef struct {
+	sd_if_t type;
+	sd_sdio_if_t *sdio_if_p;
+} sd_card_t;
+
+extern bool sd_init_driver(void);
+extern size_t sd_get_num(void);
+extern sd_card_t *sd_get_by_num(size_t num);
+
+#endif /* !HW_CONFIG_H */
@@ -0,0 +1,79 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK base header for the
+ * host build, with the board definitions of the GEEK used by
+ * the machine.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef PICO_H
+#define PICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifndef PICO_HOST
+#define PICO_HOST 1
+#endif
+/* the machine is built like for a RP2040 unless told otherwise */
+#if !defined(PICO_RP2040) && !defined(PICO_RP2350)
+#define PICO_RP2040 1
+#endif
+#ifndef PICO_RP2040
+#define PICO_RP2040 0
+#endif
+#ifndef PICO_RP2350
+#define PICO_RP2350 0
+#endif
+#ifndef PICO_RISCV
+#define PICO_RISCV 0
+#endif
+
+#define __aligned(x)		__attribute__((aligned(x)))
+#define __not_in_flash(group)
+#define __not_in_flash_func(func) func
+#define __time_critical_func(func) func
+#define __scratch_x(group)
+#define __scratch_y(group)
+#ifndef __unused
+#define __unused		__attribute__((unused))
+#endif
+#ifndef __CONCAT
+#define __CONCAT1(x, y)		x ## y
+#define __CONCAT(x, y)		__CONCAT1(x, y)
+#endif
+
+#define count_of(a)		(sizeof(a) / sizeof((a)[0]))
+
+/* board definitions used by the machine */
+#define PICO_DEFAULT_I2C_SDA_PIN	28
+#define PICO_DEFAULT_I2C_SCL_PIN	29
+#define PICO_SD_CMD_PIN			18
+#define PICO_SD_DAT0_PIN		19
+#define WAVESHARE_GEEK_LCD_WIDTH	240
+#define WAVESHARE_GEEK_LCD_HEIGHT	135
+
+/* the cores are threads, events are signalled with a condition variable */
+extern void host_wfe(void);
+extern void host_sev(void);
+extern void host_wfi(void);
+
+static inline void __wfe(void) { host_wfe(); }
+static inline void __sev(void) { host_sev(); }
+static inline void __wfi(void) { host_wfi(); }
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __nop(void) { }
+
+extern unsigned int get_core_num(void);
+
+extern void panic(const char *fmt, ...)
+	__attribute__((noreturn, format(printf, 1, 2)));
+
+#endif /* !PICO_H */
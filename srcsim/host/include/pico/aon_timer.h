@@ -0,0 +1,24 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build,
+ * the always-on timer runs with an offset to the host clock.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef PICO_AON_TIMER_H
+#define PICO_AON_TIMER_H
+
+#include <time.h>
+
+#include "pico.h"
+
+extern void aon_timer_start(const struct timespec *ts);
+extern bool aon_timer_set_time(const struct timespec *ts);
+extern bool aon_timer_get_time(struct timespec *ts);
+
+#endif /* !PICO_AON_TIMER_H */
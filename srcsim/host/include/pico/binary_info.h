@@ -0,0 +1,20 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build,
+ * there is no binary info for picotool.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef PICO_BINARY_INFO_H
+#define PICO_BINARY_INFO_H
+
+#define bi_decl(...)
+#define bi_1pin_with_name(...)
+#define bi_2pins_with_names(...)
+
+#endif /* !PICO_BINARY_INFO_H */
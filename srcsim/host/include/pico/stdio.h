@@ -0,0 +1,42 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build.
+ * Like with the USB stdio of the SDK, console input comes from a
+ * CDC interface, which is stdin of the host process here.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 chars available callback
+ */
+
+#ifndef PICO_STDIO_H
+#define PICO_STDIO_H
+
+#include <stdio.h>
+
+#include "pico.h"
+
+#define PICO_ERROR_TIMEOUT	(-1)
+
+extern bool stdio_init_all(void);
+extern int host_getchar(void);
+extern int getchar_timeout_us(uint32_t timeout_us);
+
+/* only the chars available callback is set through the driver */
+typedef struct stdio_driver {
+	void (*set_chars_available_callback)(void (*fn)(void *), void *param);
+} stdio_driver_t;
+
+/* input must go through the CDC substitute */
+#undef getchar
+#define getchar()	host_getchar()
+
+static inline int putchar_raw(int c)
+{
+	return putchar(c);
+}
+
+#endif /* !PICO_STDIO_H */
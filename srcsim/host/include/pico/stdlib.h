@@ -0,0 +1,20 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef PICO_STDLIB_H
+#define PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/stdio.h"
+#include "pico/time.h"
+#include "hardware/uart.h"
+
+#endif /* !PICO_STDLIB_H */
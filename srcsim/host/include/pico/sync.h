@@ -0,0 +1,46 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 mutex_try_enter()
+ */
+
+#ifndef PICO_SYNC_H
+#define PICO_SYNC_H
+
+#include <pthread.h>
+
+#include "pico.h"
+#include "hardware/sync.h"
+
+typedef struct {
+	pthread_mutex_t m;
+} mutex_t;
+
+static inline void mutex_init(mutex_t *mtx)
+{
+	pthread_mutex_init(&mtx->m, NULL);
+}
+
+static inline void mutex_enter_blocking(mutex_t *mtx)
+{
+	pthread_mutex_lock(&mtx->m);
+}
+
+static inline bool mutex_try_enter(mutex_t *mtx, uint32_t *owner_out)
+{
+	(void) owner_out;
+	return pthread_mutex_trylock(&mtx->m) == 0;
+}
+
+static inline void mutex_exit(mutex_t *mtx)
+{
+	pthread_mutex_unlock(&mtx->m);
+}
+
+#endif /* !PICO_SYNC_H */
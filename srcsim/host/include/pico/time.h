@@ -0,0 +1,74 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the Raspberry Pi Pico SDK header for the host build,
+ * times are microseconds since the start of the program.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 repeating alarms
+ * 16-OCT-2026 make_timeout_time_us()
+ */
+
+#ifndef PICO_TIME_H
+#define PICO_TIME_H
+
+#include "pico.h"
+
+typedef uint64_t absolute_time_t;
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+extern uint64_t time_us_64(void);
+extern void sleep_us(uint64_t us);
+extern void sleep_ms(uint32_t ms);
+extern bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+extern alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback,
+				  void *user_data, bool fire_if_past);
+extern alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback,
+				  void *user_data, bool fire_if_past);
+
+static inline uint32_t time_us_32(void)
+{
+	return (uint32_t) time_us_64();
+}
+
+static inline absolute_time_t get_absolute_time(void)
+{
+	return time_us_64();
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t)
+{
+	return t;
+}
+
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us)
+{
+	return t + us;
+}
+
+static inline absolute_time_t make_timeout_time_us(uint64_t us)
+{
+	return time_us_64() + us;
+}
+
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms)
+{
+	return time_us_64() + (uint64_t) ms * 1000;
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from,
+					    absolute_time_t to)
+{
+	return (int64_t) (to - from);
+}
+
+static inline bool time_reached(absolute_time_t t)
+{
+	return time_us_64() >= t;
+}
+
+#endif /* !PICO_TIME_H */
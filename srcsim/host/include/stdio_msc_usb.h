@@ -0,0 +1,31 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the MSC USB stdio library for the host build, the
+ * CDC interface is stdin/stdout of the host process and there is no
+ * mass storage access.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 second CDC interface
+ * 16-OCT-2026 input without waiting
+ */
+
+#ifndef _STDIO_MSC_USB_H
+#define _STDIO_MSC_USB_H
+
+#include "pico/stdio.h"
+
+extern stdio_driver_t stdio_msc_usb;
+
+extern bool stdio_msc_usb_init(void);
+extern int stdio_msc_usb_in_chars_try(char *buf, int length);
+extern int stdio_msc_usb_out_chars_try(const char *buf, int length);
+extern void stdio_msc_usb_do_msc(void);
+extern bool stdio_msc_usb_aux_connected(void);
+extern int stdio_msc_usb_aux_in_chars_try(char *buf, int length);
+extern int stdio_msc_usb_aux_out_chars_try(const char *buf, int length);
+
+#endif /* !_STDIO_MSC_USB_H */
@@ -0,0 +1,25 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Substitute of the TinyUSB header for the host build, the CDC
+ * interface is stdin/stdout of the host process.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 tusb_init()
+ */
+
+#ifndef TUSB_H
+#define TUSB_H
+
+#include "pico.h"
+
+extern bool tusb_init(void);
+extern bool tud_cdc_connected(void);
+
+/* callback in the machine, when the terminal sends a break */
+extern void tud_cdc_send_break_cb(uint8_t itf, uint16_t duration_ms);
+
+#endif /* !TUSB_H */
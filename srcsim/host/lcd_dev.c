@@ -0,0 +1,119 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * LCD device of the host build, there is no display, the last frame
+ * sent is kept, so that it can be dumped as PPM image.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "pico.h"
+
+#include "lcd_dev.h"
+#include "draw.h"
+#include "host.h"
+
+#if COLOR_DEPTH == 12
+#define FB_STRIDE (((WAVESHARE_GEEK_LCD_WIDTH + 1) / 2) * 3)
+#else
+#define FB_STRIDE (WAVESHARE_GEEK_LCD_WIDTH * 2)
+#endif
+
+const char *host_fb_file;		/* file for frame buffer dumps */
+volatile bool host_fb_dump;		/* dump frame buffer requested */
+
+static pthread_mutex_t fb_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t fb[WAVESHARE_GEEK_LCD_HEIGHT * FB_STRIDE];
+static bool fb_rotated;
+
+void lcd_dev_init(void)
+{
+}
+
+void lcd_dev_exit(void)
+{
+}
+
+void lcd_dev_backlight(uint8_t value)
+{
+	(void) value;
+}
+
+void lcd_dev_rotation(bool rotated)
+{
+	fb_rotated = rotated;
+}
+
+void lcd_dev_send_pixmap(draw_pixmap_t *pixmap)
+{
+	pthread_mutex_lock(&fb_mutex);
+	memcpy(fb, pixmap->bits, sizeof(fb));
+	pthread_mutex_unlock(&fb_mutex);
+
+	if (host_fb_dump) {
+		host_fb_dump = false;
+		host_dump_fb();
+	}
+}
+
+/*
+ * get the color of pixel x, y as 24 bit RGB
+ */
+static void fb_pixel(int x, int y, uint8_t *rgb)
+{
+#if COLOR_DEPTH == 12
+	const uint8_t *p = &fb[y * FB_STRIDE + (x / 2) * 3];
+	unsigned int c;
+
+	if (x & 1)
+		c = ((p[1] & 0xf) << 8) | p[2];
+	else
+		c = (p[0] << 4) | (p[1] >> 4);
+	rgb[0] = ((c >> 8) & 0xf) * 17;
+	rgb[1] = ((c >> 4) & 0xf) * 17;
+	rgb[2] = (c & 0xf) * 17;
+#else
+	const uint8_t *p = &fb[y * FB_STRIDE + x * 2];
+	unsigned int c = (p[0] << 8) | p[1];
+
+	rgb[0] = ((c >> 11) & 0x1f) * 255 / 31;
+	rgb[1] = ((c >> 5) & 0x3f) * 255 / 63;
+	rgb[2] = (c & 0x1f) * 255 / 31;
+#endif
+}
+
+/*
+ * write the last frame into the dump file
+ */
+void host_dump_fb(void)
+{
+	FILE *fp;
+	uint8_t rgb[3];
+	int x, y;
+
+	if (host_fb_file == NULL || (fp = fopen(host_fb_file, "wb")) == NULL)
+		return;
+
+	pthread_mutex_lock(&fb_mutex);
+	fprintf(fp, "P6\n%d %d\n255\n", WAVESHARE_GEEK_LCD_WIDTH,
+		WAVESHARE_GEEK_LCD_HEIGHT);
+	for (y = 0; y < WAVESHARE_GEEK_LCD_HEIGHT; y++)
+		for (x = 0; x < WAVESHARE_GEEK_LCD_WIDTH; x++) {
+			if (fb_rotated)
+				fb_pixel(WAVESHARE_GEEK_LCD_WIDTH - 1 - x,
+					 WAVESHARE_GEEK_LCD_HEIGHT - 1 - y,
+					 rgb);
+			else
+				fb_pixel(x, y, rgb);
+			fwrite(rgb, 1, 3, fp);
+		}
+	pthread_mutex_unlock(&fb_mutex);
+	fclose(fp);
+}
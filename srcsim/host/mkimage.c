@@ -0,0 +1,126 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * Create the MicroSD image file of the host build with a FAT file
+ * system and copy a directory tree of the host into it, so that no
+ * other tools are needed for setting up the image.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include "ff.h"
+
+#include "host.h"
+
+#define COPY_BUFSZ	4096
+
+static BYTE copy_buf[COPY_BUFSZ];
+static size_t root_len;		/* length of the host directory name */
+
+/*
+ * copy the host file 'src' into the file 'dst' in the image
+ */
+static int copy_file(const char *src, const char *dst)
+{
+	FIL f;
+	FRESULT res;
+	unsigned int bw;
+	ssize_t n;
+	int fd;
+
+	if ((fd = open(src, O_RDONLY)) < 0) {
+		perror(src);
+		return -1;
+	}
+	if ((res = f_open(&f, dst, FA_WRITE | FA_CREATE_ALWAYS)) != FR_OK) {
+		fprintf(stderr, "%s: f_open error %d\n", dst, res);
+		close(fd);
+		return -1;
+	}
+	while ((n = read(fd, copy_buf, COPY_BUFSZ)) > 0) {
+		if ((res = f_write(&f, copy_buf, n, &bw)) != FR_OK ||
+		    bw < (unsigned int) n) {
+			fprintf(stderr, "%s: f_write error %d\n", dst, res);
+			n = -1;
+			break;
+		}
+	}
+	f_close(&f);
+	close(fd);
+	return (n < 0) ? -1 : 0;
+}
+
+/*
+ * copy a file or directory of the host directory tree into the image
+ */
+static int copy_entry(const char *path, const struct stat *st, int type,
+		      struct FTW *ftw)
+{
+	const char *dst = path + root_len;
+	FRESULT res;
+
+	(void) st;
+	(void) ftw;
+
+	if (*dst == '\0')
+		return 0;	/* the top directory itself */
+
+	switch (type) {
+	case FTW_D:
+		res = f_mkdir(dst);
+		if (res != FR_OK && res != FR_EXIST) {
+			fprintf(stderr, "%s: f_mkdir error %d\n", dst, res);
+			return -1;
+		}
+		return 0;
+	case FTW_F:
+		printf("%s\n", dst);
+		return copy_file(path, dst);
+	default:
+		return 0;
+	}
+}
+
+/*
+ * create the image with 'size' MB and copy directory 'dir' into it
+ */
+int host_mkimage(const char *dir, unsigned int size)
+{
+	static BYTE work[FF_MAX_SS * 4];
+	MKFS_PARM opt = { .fmt = FM_ANY };
+	FATFS fs;
+	FRESULT res;
+	int fd, err;
+
+	fd = open(host_sd_image, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || ftruncate(fd, (off_t) size << 20) < 0) {
+		perror(host_sd_image);
+		return -1;
+	}
+	close(fd);
+
+	if ((res = f_mkfs("", &opt, work, sizeof(work))) != FR_OK) {
+		fprintf(stderr, "f_mkfs error %d\n", res);
+		return -1;
+	}
+	if ((res = f_mount(&fs, "", 1)) != FR_OK) {
+		fprintf(stderr, "f_mount error %d\n", res);
+		return -1;
+	}
+	root_len = strlen(dir);
+	while (root_len > 1 && dir[root_len - 1] == '/')
+		root_len--;
+	err = nftw(dir, copy_entry, 16, FTW_PHYS);
+	f_unmount("");
+	return err;
+}
@@ -0,0 +1,367 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements a device for the transfer of files between
+ * the directory /HOST80 on the MicroSD and programs of the machine.
+ *
+ * I/O port 9 write, bits 4-7 command, bits 0-3 file number:
+ * 1 = set address of the command bytes, LSB and MSB follow
+ * 2 = open file for reading
+ * 3 = create file for writing, an existing file is overwritten
+ * 4 = read record
+ * 5 = write record
+ * 6 = close file
+ * 7 = get first directory entry
+ * 8 = get next directory entry
+ *
+ * The command bytes are DMA address low, DMA address high and the
+ * number of bytes in the record. For open and create the DMA address
+ * points to the file name in the format of a CP/M FCB, 8 characters
+ * name and 3 characters extension, padded with blanks. Read stores
+ * the next record at the DMA address and the number of bytes read in
+ * the count byte, the rest of a short last record is filled with 1AH.
+ * Write writes count bytes from the DMA address, 0 for a whole record.
+ *
+ * The directory commands store an entry for the next file at the DMA
+ * address, the name in the FCB format, a 0 and the file size in bytes
+ * LSB first. Only the short names of the files are used. The file
+ * number doesn't matter for them.
+ *
+ * Reading port 9 returns the status of the last command. The files
+ * are kept open between the commands, so records are transferred
+ * with the speed of the MicroSD.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+#include "simmem.h"
+#include "simio.h"
+
+#include "ff.h"
+
+#include "disks.h"
+#include "hostfile.h"
+#include "draw.h"
+#include "lcd.h"
+
+/* files, kept open until closed by the program or the end */
+static FIL hf_file[HF_NUMFILES];
+static bool hf_open[HF_NUMFILES];
+
+/* directory for the directory commands */
+static DIR hf_dir;
+static bool hf_dir_open;
+
+/* buffer for records crossing the bank boundary */
+static unsigned char hf_buf[HF_RECLEN];
+
+static WORD hf_cmd_addr;	/* address of the command bytes */
+static int hf_state;		/* 1,2 = LSB/MSB of address follows */
+static BYTE hf_stat;		/* status of the last command */
+
+/*
+ * close file 'fn'
+ */
+static FRESULT close_hostfile(int fn)
+{
+	FRESULT res = FR_OK;
+
+	if (hf_open[fn]) {
+		res = f_close(&hf_file[fn]);
+		hf_open[fn] = false;
+	}
+	return res;
+}
+
+/*
+ * close all files and the directory, must be done
+ * before the MicroSD is unmounted
+ */
+void exit_hostfiles(void)
+{
+	register int i;
+
+	for (i = 0; i < HF_NUMFILES; i++)
+		close_hostfile(i);
+	if (hf_dir_open) {
+		f_closedir(&hf_dir);
+		hf_dir_open = false;
+	}
+}
+
+/*
+ * flush pending writes of all open files
+ */
+void sync_hostfiles(void)
+{
+	register int i;
+
+	for (i = 0; i < HF_NUMFILES; i++)
+		if (hf_open[i])
+			f_sync(&hf_file[i]);
+}
+
+/*
+ * get the path name of the file with the name in FCB format @ addr
+ */
+static BYTE get_path(WORD addr, char *path)
+{
+	char *p;
+	int c;
+	bool blank = false;
+	register int i;
+
+	strcpy(path, HF_DIR "/");
+	p = path + strlen(path);
+	for (i = 0; i < HF_NAMELEN; i++) {
+		if (i == 8) {
+			*p++ = '.';
+			blank = false;
+		}
+		c = dma_read(addr + i) & 0x7f; /* strip attribute bits */
+		if (c == ' ') {
+			blank = true;
+			continue;
+		}
+		/* blanks only at the end of name and extension */
+		if (blank || c < ' ' || c == 0x7f ||
+		    strchr("\"*+,./:;<=>?[\\]|", c) != NULL)
+			return HF_STAT_NAME;
+		*p++ = toupper(c);
+	}
+	if (p[-1] == '.')
+		p--;			/* no extension */
+	*p = '\0';
+	if (path[sizeof(HF_DIR)] == '.' || path[sizeof(HF_DIR)] == '\0')
+		return HF_STAT_NAME;	/* no name */
+
+	return HF_STAT_OK;
+}
+
+/*
+ * open file 'fn' with the name @ addr for reading or writing
+ */
+static BYTE open_hostfile(int fn, WORD addr, BYTE mode)
+{
+	char path[sizeof(HF_DIR) + HF_NAMELEN + 2];
+	BYTE stat;
+
+	if ((stat = get_path(addr, path)) != HF_STAT_OK)
+		return stat;
+
+	close_hostfile(fn);
+	if (f_open(&hf_file[fn], path, mode) != FR_OK)
+		return HF_STAT_NOFILE;
+	hf_open[fn] = true;
+
+	return HF_STAT_OK;
+}
+
+/*
+ * read the next record of file 'fn' into memory @ addr
+ */
+static BYTE read_hostfile(int fn, WORD addr)
+{
+	BYTE stat = HF_STAT_OK;
+	unsigned int br;
+	register BYTE *m;
+	register int i;
+
+	if (!hf_open[fn])
+		return HF_STAT_NOTOPEN;
+	if ((unsigned int) addr + HF_RECLEN > 0xff00)
+		return HF_STAT_DMAADR;
+
+	led_color = (led_color & ~C_GREEN) | C_GREEN;
+
+	if ((m = dma_ptr(addr, HF_RECLEN)) == NULL)
+		m = &hf_buf[0];		/* record crosses banks */
+	if (f_read(&hf_file[fn], m, HF_RECLEN, &br) != FR_OK) {
+		stat = HF_STAT_READ;
+		br = 0;
+	} else if (br == 0)
+		stat = HF_STAT_EOF;
+	else {
+		memset(m + br, HF_EOF, HF_RECLEN - br);
+		if (m == &hf_buf[0])
+			for (i = 0; i < HF_RECLEN; i++)
+				dma_write(addr + i, hf_buf[i]);
+	}
+	dma_write(hf_cmd_addr + HFCMD_CNT, br);
+
+	led_color &= ~C_GREEN;
+
+	return stat;
+}
+
+/*
+ * write 'count' bytes from memory @ addr to file 'fn'
+ */
+static BYTE write_hostfile(int fn, WORD addr, int count)
+{
+	BYTE stat = HF_STAT_OK;
+	unsigned int bw;
+	register BYTE *m;
+	register int i;
+
+	if (!hf_open[fn])
+		return HF_STAT_NOTOPEN;
+	if (count == 0 || count > HF_RECLEN)
+		count = HF_RECLEN;
+	if ((unsigned int) addr + count > 0xff00)
+		return HF_STAT_DMAADR;
+
+	led_color = (led_color & ~C_RED) | C_RED;
+
+	if ((m = dma_ptr(addr, count)) == NULL) {
+		/* record crosses banks */
+		for (i = 0; i < count; i++)
+			hf_buf[i] = dma_read(addr + i);
+		m = &hf_buf[0];
+	}
+	if (f_write(&hf_file[fn], m, count, &bw) != FR_OK ||
+	    bw < (unsigned int) count)
+		stat = HF_STAT_WRITE;
+
+	led_color &= ~C_RED;
+
+	return stat;
+}
+
+/*
+ * store the entry of the next file in the directory @ addr
+ */
+static BYTE read_hostdir(bool first, WORD addr)
+{
+	FILINFO fno;
+	const char *name, *ext;
+	register int i;
+
+	if ((unsigned int) addr + HF_DIRLEN > 0xff00)
+		return HF_STAT_DMAADR;
+
+	if (first) {
+		if (hf_dir_open)
+			f_closedir(&hf_dir);
+		hf_dir_open = f_opendir(&hf_dir, HF_DIR) == FR_OK;
+		if (!hf_dir_open)
+			return HF_STAT_NOFILE;
+	} else if (!hf_dir_open)
+		return HF_STAT_NOTOPEN;
+
+	for (;;) {
+		if (f_readdir(&hf_dir, &fno) != FR_OK ||
+		    fno.fname[0] == '\0') {
+			f_closedir(&hf_dir);
+			hf_dir_open = false;
+			return HF_STAT_EOF;
+		}
+		if (!(fno.fattrib & (AM_DIR | AM_HID | AM_SYS)))
+			break;
+	}
+
+	/* the short name of the file, in FCB format */
+	name = fno.altname[0] ? fno.altname : fno.fname;
+	if ((ext = strchr(name, '.')) == NULL)
+		ext = name + strlen(name);
+	for (i = 0; i < 8; i++)
+		dma_write(addr + i, name + i < ext ? toupper(name[i]) : ' ');
+	if (*ext == '.')
+		ext++;
+	for (i = 0; i < 3; i++)
+		dma_write(addr + 8 + i, *ext ? toupper(*ext++) : ' ');
+	dma_write(addr + 11, 0);
+	for (i = 0; i < 4; i++)
+		dma_write(addr + 12 + i, (DWORD) fno.fsize >> (i * 8));
+
+	return HF_STAT_OK;
+}
+
+/*
+ * I/O handler for host file device port write
+ */
+void hf_out(BYTE data)
+{
+	int fn = data & 0x0f;
+	WORD addr;
+
+	sio_not_idle();
+
+	switch (hf_state) {
+	case 1:
+		hf_cmd_addr = data;
+		hf_state++;
+		return;
+	case 2:
+		hf_cmd_addr |= data << 8;
+		hf_state = 0;
+		return;
+	default:
+		break;
+	}
+
+	if ((data & 0xf0) == 0x10) {
+		hf_state = 1;
+		return;
+	}
+	if (fn >= HF_NUMFILES && (data & 0xf0) < 0x70) {
+		hf_stat = HF_STAT_CMD;
+		return;
+	}
+
+	/* FatFS is not reentrant, wait for asynchronous FDC commands */
+	wait_disks();
+
+	addr = dma_read(hf_cmd_addr + HFCMD_DMAL) |
+	       (dma_read(hf_cmd_addr + HFCMD_DMAH) << 8);
+
+	switch (data & 0xf0) {
+	case 0x20:
+		hf_stat = open_hostfile(fn, addr, FA_READ);
+		break;
+	case 0x30:
+		hf_stat = open_hostfile(fn, addr, FA_WRITE | FA_CREATE_ALWAYS);
+		break;
+	case 0x40:
+		hf_stat = read_hostfile(fn, addr);
+		break;
+	case 0x50:
+		hf_stat = write_hostfile(fn, addr,
+					 dma_read(hf_cmd_addr + HFCMD_CNT));
+		break;
+	case 0x60:
+		if (!hf_open[fn])
+			hf_stat = HF_STAT_NOTOPEN;
+		else if (close_hostfile(fn) != FR_OK)
+			hf_stat = HF_STAT_WRITE;
+		else
+			hf_stat = HF_STAT_OK;
+		break;
+	case 0x70:
+	case 0x80:
+		hf_stat = read_hostdir((data & 0xf0) == 0x70, addr);
+		break;
+	default:
+		hf_stat = HF_STAT_CMD;
+		break;
+	}
+}
+
+/*
+ * I/O handler for host file device port read
+ */
+BYTE hf_in(void)
+{
+	return hf_stat;
+}
@@ -0,0 +1,48 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements a device for the transfer of files between
+ * the directory /HOST80 on the MicroSD and programs of the machine.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef HOSTFILE_INC
+#define HOSTFILE_INC
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define HF_NUMFILES	2	/* number of files open at the same time */
+#define HF_DIR		"/HOST80" /* directory with the files */
+#define HF_RECLEN	128	/* record length, same as CP/M */
+#define HF_NAMELEN	11	/* file name like in a CP/M FCB */
+#define HF_DIRLEN	16	/* length of a directory entry */
+#define HF_EOF		0x1a	/* fills the rest of the last record */
+
+/* offsets in the command bytes */
+#define HFCMD_DMAL	0	/* DMA address low */
+#define HFCMD_DMAH	1	/* DMA address high */
+#define HFCMD_CNT	2	/* bytes in the record */
+
+/* status codes */
+#define HF_STAT_OK	0	/* command OK */
+#define HF_STAT_CMD	1	/* invalid command or file number */
+#define HF_STAT_NOFILE	2	/* file not found or can't be created */
+#define HF_STAT_NOTOPEN	3	/* file not open */
+#define HF_STAT_EOF	4	/* end of file or directory */
+#define HF_STAT_READ	5	/* read error */
+#define HF_STAT_WRITE	6	/* write error */
+#define HF_STAT_DMAADR	7	/* illegal DMA address */
+#define HF_STAT_NAME	8	/* invalid file name */
+
+extern void exit_hostfiles(void);
+extern void sync_hostfiles(void);
+
+extern BYTE hf_in(void);
+extern void hf_out(BYTE data);
+
+#endif /* !HOSTFILE_INC */
@@ -15,6 +15,7 @@
 #include "simglb.h"
 #include "simmem.h"
 
+#include "disks.h"
 #include "lcd.h"
 #include "draw.h"
 #include "picosim.h"
@@ -88,7 +89,6 @@ static void __not_in_flash_func(lcd_task)(void)
 {
 	absolute_time_t t;
 	bool first = true;
-	int64_t d;
 	lcd_func_t curr_func = NULL;
 
 	/* initialize the LCD controller */
@@ -112,14 +112,13 @@ static void __not_in_flash_func(lcd_task)(void)
 		lcd_dev_send_pixmap(draw_pixmap);
 		mutex_exit(&lcd_mutex);
 
-		d = absolute_time_diff_us(t, get_absolute_time());
-		// printf("SLEEP %lld\n", LCD_REFRESH_US - d);
-		if (d < LCD_REFRESH_US)
-			sleep_us(LCD_REFRESH_US - d);
 #if 0
-		else
+		if (absolute_time_diff_us(t, get_absolute_time()) >=
+		    LCD_REFRESH_US)
 			puts("REFRESH!");
 #endif
+		/* execute asynchronous FDC commands until next refresh */
+		fdc_async_work(delayed_by_us(t, LCD_REFRESH_US));
 	}
 
 	mutex_enter_blocking(&lcd_mutex);
@@ -508,6 +507,8 @@ static void __not_in_flash_func(lcd_draw_cpu_reg)(bool first)
 #define MEM_XOFF 3
 #define MEM_YOFF 0
 #define MEM_BRDR 3
+/* columns for the banked segment, 512 bytes each */
+#define MEM_BCOLS (BNKSIZ < 49152 ? BNKSIZ / 512 : 96)
 
 static void __not_in_flash_func(lcd_draw_memory)(bool first)
 {
@@ -537,9 +538,10 @@ static void __not_in_flash_func(lcd_draw_memory)(bool first)
 				draw_pixel(x, y, (*p++ * 2654435769U) >> 20);
 			}
 		}
-		p = (uint32_t *) bnk1;
+		/* the selected bank, or bank 1 if bank 0 is selected */
+		p = (uint32_t *) banks[selbnk ? selbnk : 1];
 		for (x = MEM_XOFF + 3 * MEM_BRDR - 1 + 128;
-		     x < MEM_XOFF + 3 * MEM_BRDR - 1 + 128 + 96; x++) {
+		     x < MEM_XOFF + 3 * MEM_BRDR - 1 + 128 + MEM_BCOLS; x++) {
 			for (y = MEM_YOFF + MEM_BRDR;
 			     y < MEM_YOFF + MEM_BRDR + 128; y++) {
 				draw_pixel(x, y, (*p++ * 2654435769U) >> 20);
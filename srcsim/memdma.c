@@ -0,0 +1,121 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements a DMA controller for block moves
+ * between the memory banks.
+ *
+ * I/O port 68 write, the bytes of a move in this order:
+ * source bank, source address low, source address high,
+ * destination bank, destination address low, destination address high,
+ * count low, count high
+ *
+ * The move is done when the count high byte is written. Bank 0FFH is
+ * the currently selected bank, addresses in the common segment are the
+ * same for all banks. The bytes are moved in ascending order like with
+ * LDIR, writes into the ROM are ignored. The CPU is charged
+ * MDMA_T_SETUP + count * MDMA_T_BYTE T states for the move.
+ *
+ * Reading port 68 returns the status of the last move and resets the
+ * byte sequence, so that the next byte written is the source bank.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#include <stdint.h>
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+#include "simmem.h"
+#include "simio.h"
+
+#include "memdma.h"
+
+static BYTE mdma_regs[8];	/* bytes of the move command */
+static int mdma_state;		/* index of the next byte */
+static BYTE mdma_stat;		/* status of the last move */
+
+/*
+ * get the number of bytes from 'addr' up to the next boundary,
+ * where the memory isn't consecutive anymore
+ */
+static unsigned int mdma_run(WORD addr)
+{
+	if (addr < BNKSIZ)
+		return BNKSIZ - addr;
+	else if (addr < 0xff00)
+		return 0xff00 - addr;
+	else
+		return 0x10000 - addr;
+}
+
+/*
+ * move 'count' bytes from 'src' in bank 'sbank'
+ * to 'dst' in bank 'dbank'
+ */
+static BYTE mdma_move(BYTE sbank, WORD src, BYTE dbank, WORD dst,
+		      unsigned int count)
+{
+	register BYTE *s, *d;
+	register unsigned int n, i;
+
+	if (sbank == MDMA_CUR_BANK)
+		sbank = selbnk;
+	if (dbank == MDMA_CUR_BANK)
+		dbank = selbnk;
+	if (sbank >= NUMBNK || dbank >= NUMBNK)
+		return MDMA_STAT_BANK;
+
+	T += MDMA_T_SETUP + count * MDMA_T_BYTE;
+
+	while (count > 0) {
+		/* move the part, which is consecutive in both banks */
+		n = mdma_run(src);
+		if ((i = mdma_run(dst)) < n)
+			n = i;
+		if (count < n)
+			n = count;
+
+		s = bank_addr(sbank, src);
+		if (dst < 0xff00) {
+			d = bank_addr(dbank, dst);
+			for (i = 0; i < n; i++)
+				*d++ = *s++;
+		}
+		src += n;
+		dst += n;
+		count -= n;
+	}
+
+	return MDMA_STAT_OK;
+}
+
+/*
+ * I/O handler for memory DMA port write
+ */
+void mdma_out(BYTE data)
+{
+	sio_not_idle();
+
+	mdma_regs[mdma_state++] = data;
+	if (mdma_state == sizeof(mdma_regs)) {
+		mdma_state = 0;
+		mdma_stat = mdma_move(mdma_regs[0],
+				      mdma_regs[1] | (mdma_regs[2] << 8),
+				      mdma_regs[3],
+				      mdma_regs[4] | (mdma_regs[5] << 8),
+				      mdma_regs[6] | (mdma_regs[7] << 8));
+	}
+}
+
+/*
+ * I/O handler for memory DMA port read
+ */
+BYTE mdma_in(void)
+{
+	mdma_state = 0;
+	return mdma_stat;
+}
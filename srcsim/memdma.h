@@ -0,0 +1,31 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements a DMA controller for block moves
+ * between the memory banks.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef MEMDMA_INC
+#define MEMDMA_INC
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define MDMA_T_SETUP	20	/* T states charged for starting a move */
+#define MDMA_T_BYTE	6	/* T states charged for each byte moved */
+
+#define MDMA_CUR_BANK	0xff	/* bank number for the selected bank */
+
+/* status codes */
+#define MDMA_STAT_OK	0	/* command OK */
+#define MDMA_STAT_BANK	1	/* invalid bank */
+
+extern BYTE mdma_in(void);
+extern void mdma_out(BYTE data);
+
+#endif /* !MEMDMA_INC */
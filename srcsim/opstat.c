@@ -0,0 +1,144 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements execution counters for all opcodes
+ * of the 8080 and Z80, including the prefixed Z80 opcodes.
+ *
+ * The opcodes are counted in memrdr() with the M1 status of the
+ * bus: an opcode fetch of a prefix selects the table for the next
+ * byte read, for DD CB and FD CB the displacement is skipped.
+ * The report shows the most executed opcodes, the CSV file has
+ * all counters that are not zero with the columns:
+ *
+ * table	8080, Z80, CB, DD, ED, FD, DDCB or FDCB
+ * opcode	opcode in hex
+ * count	number of executions
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+
+#ifdef WANT_OPSTAT
+
+#include "simdefs.h"
+#include "simglb.h"
+
+#include "ff.h"
+
+#include "disks.h"
+#include "opstat.h"
+
+opcnt_t opstat[OPS_NTAB][256];	/* the counters */
+opcnt_t *opstat_pfx;		/* table for the byte after a prefix */
+BYTE opstat_skip;		/* skip displacement of DD CB/FD CB */
+
+static const char *const opstat_name[OPS_NTAB] = {
+	"8080", "Z80", "CB", "DD", "ED", "FD", "DDCB", "FDCB"
+};
+
+/* opcode bytes shown in the report before the opcode */
+static const char *const opstat_pfxs[OPS_NTAB] = {
+	"", "", "CB ", "DD ", "ED ", "FD ", "DD CB dd ", "FD CB dd "
+};
+
+/*
+ * clear all counters
+ */
+void reset_op_stats(void)
+{
+	memset(opstat, 0, sizeof(opstat));
+	opstat_pfx = NULL;
+	opstat_skip = 0;
+}
+
+/*
+ * print the total of each table and the most executed opcodes
+ */
+void report_op_stats(void)
+{
+	uint64_t total = 0, sum, prev_cnt = UINT64_MAX;
+	register int i, j;
+	int n, prev = -1, best;
+
+	for (i = 0; i < OPS_NTAB; i++) {
+		for (sum = 0, j = 0; j < 256; j++)
+			sum += opstat[i][j];
+		if (sum > 0)
+			printf("%-4s opcodes executed: %" PRIu64 "\n",
+			       opstat_name[i], sum);
+		total += sum;
+	}
+	if (total == 0) {
+		puts("No opcodes executed");
+		return;
+	}
+
+	/* the most executed opcodes in descending order, */
+	/* opcodes with the same count in the order of the tables */
+	printf("\nMost executed opcodes:\n");
+	for (n = 0; n < OPSTAT_TOP; n++) {
+		best = -1;
+		for (i = 0; i < OPS_NTAB * 256; i++) {
+			sum = opstat[i >> 8][i & 0xff];
+			if (sum == 0 || sum > prev_cnt ||
+			    (sum == prev_cnt && i <= prev))
+				continue;
+			if (best < 0 || sum > opstat[best >> 8][best & 0xff])
+				best = i;
+		}
+		if (best < 0)
+			break;
+		prev = best;
+		prev_cnt = opstat[best >> 8][best & 0xff];
+		printf("%-4s %s%02X  %12" PRIu64 "  %5.2f%%\n",
+		       opstat_name[best >> 8], opstat_pfxs[best >> 8],
+		       best & 0xff, prev_cnt,
+		       (double) prev_cnt * 100.0 / total);
+	}
+}
+
+/*
+ * export the counters into a CSV file on the MicroSD
+ */
+void save_op_stats(void)
+{
+	char buf[48];
+	unsigned int bw;
+	register int i, j;
+	int len;
+	FRESULT res;
+
+	/* FatFS is not reentrant, wait for asynchronous FDC commands */
+	wait_disks();
+
+	res = f_open(&sd_file, OPSTAT_FILE, FA_WRITE | FA_CREATE_ALWAYS);
+	if (res != FR_OK) {
+		printf("Can't create %s\n", OPSTAT_FILE);
+		return;
+	}
+	res = f_write(&sd_file, "table,opcode,count\n", 19, &bw);
+	for (i = 0; i < OPS_NTAB && res == FR_OK; i++) {
+		for (j = 0; j < 256 && res == FR_OK; j++) {
+			if (opstat[i][j] == 0)
+				continue;
+			len = snprintf(buf, sizeof(buf), "%s,%02X,%" PRIu64
+				       "\n", opstat_name[i], j,
+				       (uint64_t) opstat[i][j]);
+			res = f_write(&sd_file, buf, len, &bw);
+		}
+	}
+	if (res != FR_OK)
+		printf("Can't write %s\n", OPSTAT_FILE);
+	f_close(&sd_file);
+}
+
+#endif /* WANT_OPSTAT */
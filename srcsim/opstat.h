@@ -0,0 +1,102 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements execution counters for all opcodes
+ * of the 8080 and Z80, including the prefixed Z80 opcodes.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef OPSTAT_INC
+#define OPSTAT_INC
+
+#include <stdint.h>
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+
+#define OPSTAT_FILE	"/OPSTAT.CSV"	/* file for the CSV export */
+#define OPSTAT_TOP	20		/* opcodes shown in the report */
+
+/* tables with the counters */
+#define OPS_8080	0	/* 8080 opcodes */
+#define OPS_Z80		1	/* Z80 opcodes without prefix */
+#define OPS_CB		2	/* Z80 opcodes with prefix CB */
+#define OPS_DD		3	/* DD */
+#define OPS_ED		4	/* ED */
+#define OPS_FD		5	/* FD */
+#define OPS_DDCB	6	/* DD CB disp */
+#define OPS_FDCB	7	/* FD CB disp */
+#define OPS_NTAB	8
+
+/* 32 bit counters save RAM on the RP2040, they wrap after 2^32 */
+#if PICO_RP2040 && !PICO_HOST
+typedef uint32_t opcnt_t;
+#else
+typedef uint64_t opcnt_t;
+#endif
+
+extern opcnt_t opstat[OPS_NTAB][256];
+extern opcnt_t *opstat_pfx;
+extern BYTE opstat_skip;
+
+extern void reset_op_stats(void);
+extern void report_op_stats(void);
+extern void save_op_stats(void);
+
+/*
+ * count the byte 'data' read by the CPU, if it is an opcode,
+ * called from memrdr() before the M1 status is cleared
+ */
+static inline void opstat_fetch(BYTE data)
+{
+	register opcnt_t *p;
+
+	if ((p = opstat_pfx) != NULL) {
+		/* next byte after a prefix */
+		if (opstat_skip) {
+			/* displacement of DD CB and FD CB */
+			opstat_skip = 0;
+			return;
+		}
+		if (data == 0xcb && (p == opstat[OPS_DD] ||
+				     p == opstat[OPS_FD])) {
+			opstat_pfx = p == opstat[OPS_DD] ? opstat[OPS_DDCB]
+							 : opstat[OPS_FDCB];
+			opstat_skip = 1;
+			return;
+		}
+		opstat_pfx = NULL;
+		p[data]++;
+	} else if (cpu_bus & CPU_M1) {
+#ifndef EXCLUDE_I8080
+		if (cpu == I8080) {
+			opstat[OPS_8080][data]++;
+			return;
+		}
+#endif
+		switch (data) {
+		case 0xcb:
+			opstat_pfx = opstat[OPS_CB];
+			break;
+		case 0xdd:
+			opstat_pfx = opstat[OPS_DD];
+			break;
+		case 0xed:
+			opstat_pfx = opstat[OPS_ED];
+			break;
+		case 0xfd:
+			opstat_pfx = opstat[OPS_FD];
+			break;
+		default:
+			opstat[OPS_Z80][data]++;
+			break;
+		}
+	}
+}
+
+#endif /* !OPSTAT_INC */
@@ -0,0 +1,260 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements a sampling profiler for the program
+ * counter of the emulated CPU.
+ *
+ * A repeating alarm samples PC and the selected bank every PCPROF_US
+ * microseconds while the CPU is running and counts the samples per
+ * address in a hash table. Addresses in the common segment are
+ * counted for bank 0. If the table is full, samples of new addresses
+ * are counted as lost.
+ *
+ * The report shows the addresses with the most samples, resolved to
+ * the nearest symbol below the address from a symbol file on the
+ * MicroSD. This can be a listing of z80asm with the symbol table at
+ * the end (.LIS), or a file with lines of hex value and symbol name
+ * pairs like the .SYM files of MAC, RMAC and LINK.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "pico/time.h"
+
+#include "sim.h"
+
+#ifdef WANT_PCPROF
+
+#include "simdefs.h"
+#include "simglb.h"
+#include "simmem.h"
+
+#include "ff.h"
+
+#include "disks.h"
+#include "pcprof.h"
+
+#define PCPROF_USED	0x80000000 /* key of used histogram entries */
+
+/* histogram, the key is bank << 16 | address | PCPROF_USED */
+static uint32_t pcp_key[PCPROF_SIZE];
+static uint32_t pcp_cnt[PCPROF_SIZE];
+static uint32_t pcp_samples;	/* samples taken */
+static uint32_t pcp_lost;	/* samples not counted, histogram full */
+
+/* the addresses shown in the report with their symbols */
+static struct {
+	uint32_t key;
+	uint32_t cnt;
+	WORD sym_addr;
+	char sym[PCPROF_SYMLEN + 1];
+} pcp_top[PCPROF_TOP];
+
+/*
+ * alarm callback, takes a sample if the CPU is running
+ */
+static int64_t pc_sample(alarm_id_t id, void *user_data)
+{
+	register uint32_t key, h;
+	register int i;
+
+	UNUSED(id);
+	UNUSED(user_data);
+
+	if (cpu_state == ST_CONTIN_RUN) {
+		key = PC | PCPROF_USED;
+		if (PC < BNKSIZ)
+			key |= (uint32_t) selbnk << 16;
+		h = (key * 2654435761u) >> (32 - PCPROF_BITS);
+		for (i = 0; i < PCPROF_PROBE; i++) {
+			if (pcp_key[h] == key) {
+				pcp_cnt[h]++;
+				break;
+			}
+			if (pcp_key[h] == 0) {
+				pcp_key[h] = key;
+				pcp_cnt[h] = 1;
+				break;
+			}
+			h = (h + 1) & (PCPROF_SIZE - 1);
+		}
+		if (i == PCPROF_PROBE)
+			pcp_lost++;
+		pcp_samples++;
+	}
+
+	return PCPROF_US;	/* next sample relative to this one */
+}
+
+/*
+ * start sampling
+ */
+void init_pc_prof(void)
+{
+	add_alarm_in_us(PCPROF_US, pc_sample, NULL, true);
+}
+
+/*
+ * clear the histogram
+ */
+void reset_pc_prof(void)
+{
+	memset(pcp_key, 0, sizeof(pcp_key));
+	memset(pcp_cnt, 0, sizeof(pcp_cnt));
+	pcp_samples = pcp_lost = 0;
+}
+
+/*
+ * check if 'name' ends with extension 'ext'
+ */
+static bool has_ext(const char *name, const char *ext)
+{
+	size_t n = strlen(name), e = strlen(ext);
+
+	return n >= e && strcasecmp(name + n - e, ext) == 0;
+}
+
+/*
+ * remember symbol 'name' with value 'val' for all addresses
+ * in the report, if it is the nearest below the address
+ */
+static void add_symbol(const char *name, const char *val, int n)
+{
+	char *end;
+	unsigned long v;
+	WORD addr;
+	register int i;
+
+	v = strtoul(val, &end, 16);
+	if (end == val || (*end != '\0' && *end != '*') || v > 0xffff)
+		return;
+
+	for (i = 0; i < n; i++) {
+		addr = pcp_top[i].key & 0xffff;
+		if (v <= addr && (pcp_top[i].sym[0] == '\0' ||
+				  v > pcp_top[i].sym_addr)) {
+			pcp_top[i].sym_addr = v;
+			strncpy(pcp_top[i].sym, name, PCPROF_SYMLEN);
+			pcp_top[i].sym[PCPROF_SYMLEN] = '\0';
+		}
+	}
+}
+
+/*
+ * read the symbols from file 'symfile' for the 'n' addresses
+ * in the report, file names without path are in /CODE80
+ */
+static void load_symbols(const char *symfile, int n)
+{
+	char path[64], line[128];
+	char *tok, *prev;
+	bool lis, in_table;
+
+	if (strchr(symfile, '/') == NULL)
+		snprintf(path, sizeof(path), "/CODE80/%s", symfile);
+	else
+		snprintf(path, sizeof(path), "%s", symfile);
+
+	/* FatFS is not reentrant, wait for asynchronous FDC commands */
+	wait_disks();
+
+	if (f_open(&sd_file, path, FA_READ) != FR_OK) {
+		printf("Can't open %s\n", path);
+		return;
+	}
+
+	/* listings have "name value" pairs after the line */
+	/* "Symbol table", other files "value name" pairs */
+	lis = has_ext(path, ".LIS");
+	in_table = !lis;
+	while (f_gets(line, sizeof(line), &sd_file) != NULL) {
+		if (!in_table) {
+			in_table = strncmp(line, "Symbol table", 12) == 0;
+			continue;
+		}
+		prev = NULL;
+		for (tok = strtok(line, " \t\r\n"); tok != NULL;
+		     tok = strtok(NULL, " \t\r\n")) {
+			if (prev == NULL) {
+				prev = tok;
+				continue;
+			}
+			if (lis)
+				add_symbol(prev, tok, n);
+			else
+				add_symbol(tok, prev, n);
+			prev = NULL;
+		}
+	}
+	f_close(&sd_file);
+}
+
+/*
+ * print the addresses with the most samples, with symbols
+ * from 'symfile', if not NULL
+ */
+void report_pc_prof(const char *symfile)
+{
+	uint32_t cnt, prev_cnt = UINT32_MAX;
+	register int i;
+	int n, prev = -1, best;
+	WORD addr;
+
+	printf("PC samples: %lu, lost: %lu\n", (unsigned long) pcp_samples,
+	       (unsigned long) pcp_lost);
+	if (pcp_samples == 0)
+		return;
+
+	/* the addresses with the most samples in descending order */
+	for (n = 0; n < PCPROF_TOP; n++) {
+		best = -1;
+		for (i = 0; i < PCPROF_SIZE; i++) {
+			cnt = pcp_cnt[i];
+			if (cnt == 0 || cnt > prev_cnt ||
+			    (cnt == prev_cnt && i <= prev))
+				continue;
+			if (best < 0 || cnt > pcp_cnt[best])
+				best = i;
+		}
+		if (best < 0)
+			break;
+		prev = best;
+		prev_cnt = pcp_cnt[best];
+		pcp_top[n].key = pcp_key[best];
+		pcp_top[n].cnt = prev_cnt;
+		pcp_top[n].sym[0] = '\0';
+	}
+
+	if (symfile != NULL && *symfile)
+		load_symbols(symfile, n);
+
+	puts("\nbank addr  samples  percent  symbol");
+	for (i = 0; i < n; i++) {
+		addr = pcp_top[i].key & 0xffff;
+		if (addr < BNKSIZ)
+			printf("%4u ", (unsigned int) (pcp_top[i].key >> 16 &
+						      0xff));
+		else
+			printf("   - ");
+		printf("%04X %8lu  %6.2f%%  ", addr,
+		       (unsigned long) pcp_top[i].cnt,
+		       (double) pcp_top[i].cnt * 100.0 / pcp_samples);
+		if (pcp_top[i].sym[0] && addr != pcp_top[i].sym_addr)
+			printf("%s+%X", pcp_top[i].sym,
+			       addr - pcp_top[i].sym_addr);
+		else if (pcp_top[i].sym[0])
+			printf("%s", pcp_top[i].sym);
+		putchar('\n');
+	}
+}
+
+#endif /* WANT_PCPROF */
@@ -0,0 +1,27 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements a sampling profiler for the program
+ * counter of the emulated CPU.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ */
+
+#ifndef PCPROF_INC
+#define PCPROF_INC
+
+#define PCPROF_US	250	/* sample interval in microseconds */
+#define PCPROF_BITS	10	/* log2 of the addresses in the histogram */
+#define PCPROF_SIZE	(1 << PCPROF_BITS)
+#define PCPROF_PROBE	8	/* max. probes for a free histogram entry */
+#define PCPROF_TOP	20	/* addresses shown in the report */
+#define PCPROF_SYMLEN	8	/* max. length of symbol names shown */
+
+extern void init_pc_prof(void);
+extern void reset_pc_prof(void);
+extern void report_pc_prof(const char *symfile);
+
+#endif /* !PCPROF_INC */
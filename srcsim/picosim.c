@@ -17,6 +17,13 @@
  * 15-JUN-2024 added access to RP2040-GEEK LCD display
  * 24-JUN-2024 added emulation of Cromemco Dazzler
  * 08-DEC-2024 ported to RP2350-GEEK
+ * 16-OCT-2026 build for the host
+ * 16-OCT-2026 measure CPU runs for benchmarks on the host
+ * 16-OCT-2026 opcode statistics
+ * 16-OCT-2026 sampling profiler for the program counter
+ * 16-OCT-2026 command lines bypass the SIO receive buffer
+ * 16-OCT-2026 wait for the SIO transmit buffer before output
+ * 16-OCT-2026 only a break on the console CDC interface stops the CPU
  */
 
 /* Raspberry SDK and FatFS includes */
@@ -26,6 +33,9 @@
 #if LIB_PICO_STDIO_USB || LIB_STDIO_MSC_USB
 #include <tusb.h>
 #endif
+#if LIB_STDIO_MSC_USB
+#include "stdio_msc_usb.h"
+#endif
 #include "pico/binary_info.h"
 #include "pico/stdlib.h"
 #include "pico/time.h"
@@ -52,6 +62,17 @@
 #include "disks.h"
 #include "draw.h"
 #include "lcd.h"
+#include "sio.h"
+#include "sd-fdc.h"
+#ifdef WANT_OPSTAT
+#include "opstat.h"
+#endif
+#ifdef WANT_PCPROF
+#include "pcprof.h"
+#endif
+#if PICO_HOST
+#include "host.h"
+#endif
 
 #ifdef WANT_ICE
 static void picosim_ice_cmd(char *cmd, WORD *wrk_addr);
@@ -74,9 +95,11 @@ int initial_lcd = LCD_STATUS_REGISTERS;
 #if LIB_PICO_STDIO_USB || (LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO)
 void tud_cdc_send_break_cb(uint8_t itf, uint16_t duration_ms)
 {
-	UNUSED(itf);
 	UNUSED(duration_ms);
 
+	if (itf != 0)
+		return;		/* not the console */
+
 	cpu_error = USERINT;
 	cpu_state = ST_STOPPED;
 }
@@ -177,7 +200,9 @@ int main(void)
 	lcd_custom_disp(lcd_draw_banner);
 	printf("\fZ80pack release %s, %s\n", RELEASE, COPYR);
 	printf("%s release %s\n", USR_COM, USR_REL);
-#if PICO_RP2350
+#if PICO_HOST
+	puts("running on the host");
+#elif PICO_RP2350
 #if PICO_RISCV
 	puts("running on Hazard3 RISC-V cores");
 #else
@@ -190,6 +215,9 @@ int main(void)
 	init_disks();		/* initialize disk drives */
 	init_memory();		/* initialize memory configuration */
 	init_io();		/* initialize I/O devices */
+#ifdef WANT_PCPROF
+	init_pc_prof();		/* start sampling the program counter */
+#endif
 	PC = 0xff00;		/* power on jump into the boot ROM */
 	config();		/* configure the machine */
 
@@ -210,15 +238,32 @@ int main(void)
 	ice_cust_help = picosim_ice_help;
 	ice_cmd_loop(0);
 #else
+#if PICO_HOST
+	host_bench_start();
+#endif
 	run_cpu();
+#if PICO_HOST
+	host_bench_stop();
+#endif
+	sio_tx_flush();		/* output of the machine before the reports */
 #endif
 
+#ifdef WANT_OPSTAT
+	save_op_stats();	/* export opcode statistics to MicroSD */
+#endif
 	exit_disks();		/* stop disk drives */
 
 #ifndef WANT_ICE
 	putchar('\n');
 	report_cpu_error();	/* check for CPU emulation errors and report */
 	report_cpu_stats();	/* print some execution statistics */
+#ifdef WANT_OPSTAT
+	report_op_stats();	/* print opcode statistics */
+#endif
+#ifdef WANT_PCPROF
+	report_pc_prof(NULL);	/* print program counter profile */
+#endif
+	report_disk_stats();	/* print disk drive statistics */
 #endif
 	puts("\nPress any key to restart CPU");
 	get_cmdline(s, 2);
@@ -242,6 +287,9 @@ int get_cmdline(char *buf, int len)
 	int i = 0;
 	char c;
 
+	sio_tx_flush();	/* output of the machine before the prompt */
+	sio_rx_stop();	/* console input directly from the drivers */
+
 	for (;;) {
 		c = getchar();
 		if ((c == BS) || (c == DEL)) {
@@ -367,6 +415,31 @@ static void picosim_ice_cmd(char *cmd, WORD *wrk_addr)
 			cmd++;
 		if (strcasecmp(cmd, "ls") == 0)
 			list_files("/CODE80", "*.BIN");
+		else if (strcasecmp(cmd, "ds") == 0)
+			report_disk_stats();
+#ifdef WANT_OPSTAT
+		else if (strcasecmp(cmd, "os") == 0)
+			report_op_stats();
+		else if (strcasecmp(cmd, "oc") == 0)
+			save_op_stats();
+		else if (strcasecmp(cmd, "oz") == 0)
+			reset_op_stats();
+#endif
+#ifdef WANT_PCPROF
+		else if (strncasecmp(cmd, "ph", 2) == 0) {
+			cmd += 2;
+			while (isspace((unsigned char) *cmd))
+				cmd++;
+			report_pc_prof(cmd);
+		} else if (strcasecmp(cmd, "pz") == 0)
+			reset_pc_prof();
+#endif
+#ifdef RAMDISK
+		else if (strcasecmp(cmd, "rs") == 0) {
+			if (save_ramdisk() != FDC_STAT_OK)
+				puts("Can't save RAM disk");
+		}
+#endif
 		else
 			puts("what??");
 		break;
@@ -383,6 +456,19 @@ static void picosim_ice_help(void)
 	puts("c                         measure clock frequency");
 	puts("r filename                read file (without .BIN) into memory");
 	puts("! ls                      list files");
+	puts("! ds                      show disk statistics");
+#ifdef WANT_OPSTAT
+	puts("! os                      show opcode statistics");
+	puts("! oc                      save opcode statistics as " OPSTAT_FILE);
+	puts("! oz                      clear opcode statistics");
+#endif
+#ifdef WANT_PCPROF
+	puts("! ph [symfile]            show PC profile, symbols from file");
+	puts("! pz                      clear PC profile");
+#endif
+#ifdef RAMDISK
+	puts("! rs                      save RAM disk into its image");
+#endif
 }
 
 #endif
@@ -28,6 +28,12 @@
 #define SBSIZE	4	/* number of software breakpoints */
 #define WANT_HB		/* hardware breakpoint */
 #endif
+/*#define WANT_ICNT*/	/* count executed instructions for benchmarks */
+/*#define WANT_OPSTAT*/	/* count executions of each opcode */
+/*#define WANT_PCPROF*/	/* sampling profiler for the program counter */
+#if defined(WANT_ICNT) || defined(WANT_OPSTAT)
+#define BUS_8080	/* the counters need the M1 status of the CPU bus */
+#endif
 
 #if PICO_RP2040
 #define MODEL "RP2040-GEEK"
@@ -35,6 +41,19 @@
 #define MODEL "RP2350-GEEK"
 #endif
 
+/* banked memory, bank 0 is 64 KB, all other banks have the size of */
+/* the banked segment, the remaining upper memory is the common segment */
+#ifndef NUMBNK
+#if PICO_RP2040
+#define NUMBNK	2	/* number of memory banks */
+#else
+#define NUMBNK	4	/* 8 fit if the RAM disk isn't used */
+#endif
+#endif
+#ifndef BNKSIZ
+#define BNKSIZ	49152	/* size of banked segment, multiple of 4 KB */
+#endif
+
 #define USR_COM "Waveshare " MODEL " Z80/8080 emulator"
 #define USR_REL "1.5"
 #define USR_CPR "Copyright (C) 2024 by Udo Munk & Thomas Eberhardt"
@@ -13,6 +13,9 @@
  * 28-MAY-2024 implemented mount/unmount of disk images
  * 03-JUN-2024 added directory list for code files and disk images
  * 31-AUG-2024 read date/time from an optional I2C battery backed RTC
+ * 16-OCT-2026 added hard disks
+ * 16-OCT-2026 added RAM disk
+ * 16-OCT-2026 added copy-on-write overlays for the disks
  */
 
 #include <stdint.h>
@@ -40,7 +43,9 @@
 #include "simio.h"
 #include "simcfg.h"
 
+#include "sd-fdc.h"
 #include "disks.h"
+#include "hdc.h"
 #include "lcd.h"
 #include "picosim.h"
 
@@ -90,6 +95,7 @@ void config(void)
 	const char *cext = "*.BIN";
 	const char *dpath = "/DISKS80";
 	const char *dext = "*.DSK";
+	const char *hext = "*.HDD";
 	char s[10];
 	unsigned int br;
 	bool go_flag = false, rotated = false;
@@ -121,6 +127,12 @@ void config(void)
 		f_read(&sd_file, &disks[1], DISKLEN, &br);
 		f_read(&sd_file, &disks[2], DISKLEN, &br);
 		f_read(&sd_file, &disks[3], DISKLEN, &br);
+		f_read(&sd_file, &hdisks[0], HDISKLEN, &br);
+		f_read(&sd_file, &hdisks[1], HDISKLEN, &br);
+#ifdef RAMDISK
+		f_read(&sd_file, &ramdisk_img, DISKLEN, &br);
+#endif
+		f_read(&sd_file, &dsk_overlay, sizeof(dsk_overlay), &br);
 		f_close(&sd_file);
 #if defined(EXCLUDE_I8080) || defined(EXCLUDE_Z80)
 		cpu = DEF_CPU;
@@ -137,6 +149,11 @@ void config(void)
 		}
 	}
 
+#ifdef RAMDISK
+	/* fill the RAM disk from its disk image */
+	load_ramdisk();
+#endif
+
 	/* Create a real-time clock structure and initiate this */
 	ds3231_init(i2c_default, PICO_DEFAULT_I2C_SDA_PIN,
 		    PICO_DEFAULT_I2C_SCL_PIN, &rtc);
@@ -220,10 +237,20 @@ void config(void)
 			printf("f - list files\n");
 			printf("r - load file\n");
 			printf("d - list disks\n");
-			printf("0 - Disk 0: %s\n", disks[0]);
-			printf("1 - Disk 1: %s\n", disks[1]);
-			printf("2 - Disk 2: %s\n", disks[2]);
-			printf("3 - Disk 3: %s\n", disks[3]);
+			for (i = 0; i < NUMDISK; i++)
+				printf("%d - Disk %d: %s%s\n", i, i, disks[i],
+				       dsk_overlay[i] ? " (overlay)" :
+				       dsk_wprot[i] ? " (read only)" : "");
+			printf("o - toggle overlay of a disk\n");
+			printf("x - discard overlay of a disk\n");
+#ifdef RAMDISK
+			printf("e - RAM disk %d: %s\n", RAMDISK, ramdisk_img);
+#endif
+			printf("h - list hard disks\n");
+			printf("i - Hard disk I: %s%s\n", hdisks[0],
+			       hd_wprot[0] ? " (read only)" : "");
+			printf("j - Hard disk J: %s%s\n", hdisks[1],
+			       hd_wprot[1] ? " (read only)" : "");
 			printf("g - run machine\n\n");
 		} else
 			menu = 1;
@@ -398,7 +425,45 @@ again:
 			if (s[0])
 				mount_disk(i, s);
 			else {
-				disks[i][0] = '\0';
+				unmount_disk(i);
+				putchar('\n');
+			}
+			break;
+
+		case 'o':
+			if ((i = get_int("drive", "", 0, NUMDISK - 1)) >= 0)
+				set_overlay(i, !dsk_overlay[i]);
+			putchar('\n');
+			break;
+
+		case 'x':
+			if ((i = get_int("drive", "", 0, NUMDISK - 1)) >= 0 &&
+			    discard_overlay(i) != FDC_STAT_OK)
+				puts("Can't discard overlay");
+			putchar('\n');
+			break;
+
+#ifdef RAMDISK
+		case 'e':
+			prompt_fn(s, "dsk");
+			mount_ramdisk(s);
+			break;
+#endif
+
+		case 'h':
+			list_files(dpath, hext);
+			putchar('\n');
+			menu = 0;
+			break;
+
+		case 'i':
+		case 'j':
+			i = tolower((unsigned char) s[0]) - 'i';
+			prompt_fn(s, "hdd");
+			if (s[0])
+				mount_hdisk(i, s);
+			else {
+				unmount_hdisk(i);
 				putchar('\n');
 			}
 			break;
@@ -426,6 +491,12 @@ again:
 		f_write(&sd_file, &disks[1], DISKLEN, &br);
 		f_write(&sd_file, &disks[2], DISKLEN, &br);
 		f_write(&sd_file, &disks[3], DISKLEN, &br);
+		f_write(&sd_file, &hdisks[0], HDISKLEN, &br);
+		f_write(&sd_file, &hdisks[1], HDISKLEN, &br);
+#ifdef RAMDISK
+		f_write(&sd_file, &ramdisk_img, DISKLEN, &br);
+#endif
+		f_write(&sd_file, &dsk_overlay, sizeof(dsk_overlay), &br);
 		f_close(&sd_file);
 	}
 }
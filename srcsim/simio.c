@@ -15,15 +15,19 @@
  * 09-JUN-2024 implemented boot ROM
  * 24-JUN-2024 added emulation of Cromemco Dazzler
  * 29-JUN-2024 implemented banked memory
+ * 16-OCT-2026 added hard disk controller
+ * 16-OCT-2026 rebuild memory page tables on bank switch
+ * 16-OCT-2026 added memory DMA controller
+ * 16-OCT-2026 sleep in idle console status polling loops
+ * 16-OCT-2026 interrupt driven, buffered console input
+ * 16-OCT-2026 buffered console output
+ * 16-OCT-2026 second SIO channel on the second USB CDC interface
+ * 16-OCT-2026 added host file device
  */
 
 /* Raspberry SDK includes */
 #include <stdio.h>
-#if LIB_PICO_STDIO_USB || (LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO)
-#include <tusb.h>
-#endif
 #include "pico/stdlib.h"
-#include "hardware/uart.h"
 
 /* Project includes */
 #include "sim.h"
@@ -34,10 +38,18 @@
 #include "simio.h"
 
 #include "dazzler.h"
+#include "disks.h"
 #include "draw.h"
+#include "hdc.h"
+#include "hostfile.h"
 #include "lcd.h"
+#include "memdma.h"
 #include "rtc80.h"
 #include "sd-fdc.h"
+#include "sio.h"
+#ifdef SIO2
+#include "stdio_msc_usb.h"
+#endif
 
 /*
  *	Forward declarations of the I/O functions
@@ -48,8 +60,19 @@ static void hwctl_out(BYTE data);
 static BYTE p000_in(void), p001_in(void), p255_in(void), hwctl_in(void);
 static void mmu_out(BYTE data), fp_out(BYTE data);
 static BYTE mmu_in(void);
+#ifdef SIO2
+static void p016_out(BYTE data), p017_out(BYTE data);
+static BYTE p016_in(void), p017_in(void);
+#endif
 
 static BYTE sio_last;	/* last character received */
+#ifdef SIO2
+static BYTE sio2_last;	/* last character received on the second channel */
+#endif
+       int sio_idle_polls;	/* status polls without input in a row */
+static Tstates_t sio_poll_T;	/* T-states at the last status poll */
+static Tstates_t sio_poll_dT;	/* T-states between the last two polls */
+static WORD sio_poll_PC;	/* PC at the last status poll */
        BYTE fp_value;	/* port 255 value, can be set from ICE or config() */
 static BYTE hwctl_lock = 0xff; /* lock status hardware control port */
 
@@ -60,11 +83,18 @@ static BYTE hwctl_lock = 0xff; /* lock status hardware control port */
 BYTE (*const port_in[256])(void) = {
 	[  0] = p000_in,	/* SIO status */
 	[  1] = p001_in,	/* SIO data */
-	[  4] = fdc_in,		/* FDC status */
+	[  4] = fdc_ext_in,	/* FDC status */
+	[  8] = hdc_in,		/* HDC status */
+	[  9] = hf_in,		/* host file device status */
 	[ 14] = dazzler_flags_in, /* Cromemco Dazzler flags */
+#ifdef SIO2
+	[ 16] = p016_in,	/* SIO 2 status */
+	[ 17] = p017_in,	/* SIO 2 data */
+#endif
 	[ 64] = mmu_in,		/* MMU */
 	[ 65] = clkc_in,	/* RTC read clock command */
 	[ 66] = clkd_in,	/* RTC read clock data */
+	[ 68] = mdma_in,	/* memory DMA status */
 	[160] = hwctl_in,	/* virtual hardware control */
 	[254] = p255_in,	/* mirror of port 255 */
 	[255] = p255_in		/* read from front panel switches */
@@ -77,12 +107,19 @@ BYTE (*const port_in[256])(void) = {
 void (*const port_out[256])(BYTE data) = {
 	[  0] = p000_out,	/* RGB LED */
 	[  1] = p001_out,	/* SIO data */
-	[  4] = fdc_out,	/* FDC command */
+	[  4] = fdc_ext_out,	/* FDC command */
+	[  8] = hdc_out,	/* HDC command */
+	[  9] = hf_out,		/* host file device command */
 	[ 14] = dazzler_ctl_out, /* Cromemco Dazzler control */
 	[ 15] = dazzler_format_out, /* Cromemco Dazzler format */
+#ifdef SIO2
+	[ 16] = p016_out,	/* SIO 2 control */
+	[ 17] = p017_out,	/* SIO 2 data */
+#endif
 	[ 64] = mmu_out,	/* MMU */
 	[ 65] = clkc_out,	/* RTC write clock command */
 	[ 66] = clkd_out,	/* RTC write clock data */
+	[ 68] = mdma_out,	/* memory DMA command */
 	[160] = hwctl_out,	/* virtual hardware control */
 	[254] = p254_out,	/* write to front panel switches */
 	[255] = fp_out		/* write to front panel lights */
@@ -95,11 +132,60 @@ void (*const port_out[256])(BYTE data) = {
  */
 void init_io(void)
 {
+	sio_init();
+}
+
+/*
+ *	Called for a status poll without input. If the program polls
+ *	in a tight loop for SIO_IDLE_POLLS times in a row, it waits for
+ *	input, sleeping the core for up to SIO_IDLE_US microseconds.
+ *	With a CPU speed set, the emulated time advances by the time
+ *	slept. Returns true, if input arrived while sleeping.
+ *
+ *	A loop waiting for input polls from the same instruction, with
+ *	the same number of T-states, at most SIO_IDLE_T, between the
+ *	polls and without any other I/O. Programs checking the console
+ *	for ^C while they work, like the BASIC interpreters after every
+ *	statement, take a different time between the polls and are not
+ *	slowed down.
+ */
+static bool sio_idle(void)
+{
+	absolute_time_t until;
+	uint64_t t0;
+	Tstates_t dT = T - sio_poll_T;
+	bool avail = false;
+
+	if (PC != sio_poll_PC || dT != sio_poll_dT || dT > SIO_IDLE_T)
+		sio_idle_polls = 0;
+	sio_poll_PC = PC;
+	sio_poll_dT = dT;
+	sio_poll_T = T;
+	if (sio_idle_polls < SIO_IDLE_POLLS) {
+		sio_idle_polls++;
+		return false;
+	}
+
+	t0 = time_us_64();
+	until = make_timeout_time_us(SIO_IDLE_US);
+	while (!(avail = sio_rx_avail()) &&
+#ifdef SIO2
+	       !sio2_rx_avail() &&	/* transfer on the second channel */
+#endif
+	       !int_int &&
+	       cpu_state == ST_CONTIN_RUN &&
+	       !best_effort_wfe_or_timeout(until))
+		;
+	if (f_flag)
+		T += (time_us_64() - t0) * f_flag;
+	sio_poll_T = T;
+
+	return avail;
 }
 
 /*
  *	I/O function port 0 read:
- *	read status of the Pico UART and return:
+ *	read status of the buffers of the Pico UART and USB and return:
  *	bit 0 = 0, character available for input from tty
  *	bit 7 = 0, transmitter ready to write character to tty
  */
@@ -107,50 +193,77 @@ static BYTE p000_in(void)
 {
 	register BYTE stat = 0b10000001; /* initially not ready */
 
-#if LIB_PICO_STDIO_UART
-	uart_inst_t *my_uart = uart_default;
+	idle_disks();	/* write back disk track cache if idle */
 
-	if (uart_is_writable(my_uart))	/* check if output to UART is possible */
+	if (sio_tx_ready())		/* check if output is possible */
 		stat &= 0b01111111;	/* if so flip status bit */
-	if (uart_is_readable(my_uart))	/* check if there is input from UART */
+
+	if (!sio_rx_on)
+		sio_rx_start();	/* console input into the receive buffer */
+	if (sio_rx_avail()) {		/* check if there is input */
 		stat &= 0b11111110;	/* if so flip status bit */
-#endif
-#if LIB_PICO_STDIO_USB || (LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO)
-	if (tud_cdc_connected()) {
-		if (tud_cdc_write_available())	/* check if output to UART is possible */
-			stat &= 0b01111111;	/* if so flip status bit */
-		if (tud_cdc_available())	/* check if there is input from UART */
-			stat &= 0b11111110;	/* if so flip status bit */
-	}
-#endif
+		sio_idle_polls = 0;	/* not idle */
+	} else if (sio_idle())
+		stat &= 0b11111110;	/* input arrived while idle */
 
 	return stat;
 }
 
 /*
  *	I/O function port 1 read:
- *	Read byte from Pico UART.
+ *	Read byte from the receive buffer of the Pico UART and USB.
  */
 static BYTE p001_in(void)
 {
-	bool input_avail = false;
+	sio_not_idle();
 
-#if LIB_PICO_STDIO_UART
-	uart_inst_t *my_uart = uart_default;
+	if (!sio_rx_on)
+		sio_rx_start();	/* console input into the receive buffer */
+	if (sio_rx_avail())
+		sio_last = sio_rx_getc();
 
-	if (uart_is_readable(my_uart))
-		input_avail = true;
-#endif
-#if LIB_PICO_STDIO_USB || (LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO)
-	if (tud_cdc_connected() && tud_cdc_available())
-		input_avail = true;
-#endif
+	return sio_last;
+}
 
-	if (input_avail)
-		sio_last = getchar();
+#ifdef SIO2
+/*
+ *	I/O function port 16 read:
+ *	status of the second SIO channel, with the bits of the
+ *	6850 ACIA of a MITS 88-2SIO:
+ *	bit 0 = 1, character available for input
+ *	bit 1 = 1, transmitter ready to write character
+ *	bit 2 = 1, no carrier, the host hasn't opened the CDC interface
+ *	bit 3 = 1, not clear to send, the same
+ */
+static BYTE __not_in_flash_func(p016_in)(void)
+{
+	register BYTE stat = 0;
 
-	return sio_last;
+	if (!stdio_msc_usb_aux_connected())
+		stat |= 0b00001100;
+	else if (sio2_tx_ready())
+		stat |= 0b00000010;
+
+	if (sio2_rx_avail()) {
+		stat |= 0b00000001;
+		sio_not_idle();		/* the console is not idle either */
+	}
+
+	return stat;
+}
+
+/*
+ *	I/O function port 17 read:
+ *	Read byte from the receive buffer of the second SIO channel.
+ */
+static BYTE __not_in_flash_func(p017_in)(void)
+{
+	if (sio2_rx_avail())
+		sio2_last = sio_ring_get(&sio2_rx);
+
+	return sio2_last;
 }
+#endif
 
 /*
  *	Input from virtual hardware control port
@@ -184,6 +297,8 @@ static BYTE p255_in(void)
  */
 static void p000_out(BYTE data)
 {
+	sio_not_idle();
+
 	if (!data) {
 		/* 0 switches LED blue off */
 		led_color &= ~C_BLUE;
@@ -195,13 +310,41 @@ static void p000_out(BYTE data)
 
 /*
  *	I/O function port 1 write:
- *	Write byte to Pico UART.
+ *	Write byte into the transmit buffer of the Pico UART and USB.
  */
 static void p001_out(BYTE data)
 {
-	putchar_raw((int) data & 0x7f); /* strip parity, some software won't */
+	sio_not_idle();
+
+	sio_tx_putc(data & 0x7f); /* strip parity, some software won't */
 }
 
+#ifdef SIO2
+/*
+ *	I/O function port 16 write:
+ *	Control register of the 6850 ACIA, the data format, clock
+ *	divider and interrupts don't matter over USB, ignored.
+ */
+static void p016_out(BYTE data)
+{
+	UNUSED(data);
+}
+
+/*
+ *	I/O function port 17 write:
+ *	Write byte into the transmit buffer of the second SIO channel,
+ *	all 8 bits for binary transfers. The status port reports the
+ *	transmitter busy while the buffer is full, if a program writes
+ *	anyway, it waits for space instead of losing the byte.
+ */
+static void __not_in_flash_func(p017_out)(BYTE data)
+{
+	sio_not_idle();
+
+	sio2_tx_putc(data);
+}
+#endif
+
 /*
  *	Port is locked until magic number 0xaa is received!
  *
@@ -216,6 +359,8 @@ static void p001_out(BYTE data)
  */
 static void hwctl_out(BYTE data)
 {
+	sio_not_idle();
+
 	/* if port is locked do nothing */
 	if (hwctl_lock && (data != 0xaa))
 		return;
@@ -231,12 +376,14 @@ static void hwctl_out(BYTE data)
 	hwctl_lock = 0xff;
 
 	if (data & 128) {
+		sync_disks();		/* flush disk images */
 		cpu_error = IOHALT;
 		cpu_state = ST_STOPPED;
 		return;
 	}
 
 	if (data & 64) {
+		sync_disks();		/* flush disk images */
 		reset_cpu();		/* reset CPU */
 		reset_memory();		/* reset memory */
 #ifdef SIMPLEPANEL
@@ -270,7 +417,10 @@ static void hwctl_out(BYTE data)
  */
 static void mmu_out(BYTE data)
 {
-	selbnk = data;
+	sio_not_idle();
+
+	if (data != selbnk)
+		select_bank(data);
 }
 
 /*
@@ -12,7 +12,22 @@
 
 #define IO_DATA_UNUSED	0xff	/* data returned on unused ports */
 
+/* idle detection of console status polling loops */
+#define SIO_IDLE_POLLS	100	/* polls without input before sleeping */
+#define SIO_IDLE_T	1000	/* max. T-states between polls of a loop */
+#define SIO_IDLE_US	1000	/* max. time to sleep in one poll */
+
 extern BYTE fp_value;
+extern int sio_idle_polls;
+
+/*
+ * the program did other I/O than polling the console status,
+ * so it isn't waiting in an idle loop
+ */
+static inline void sio_not_idle(void)
+{
+	sio_idle_polls = 0;
+}
 
 extern BYTE (*const port_in[256])(void);
 extern void (*const port_out[256])(BYTE data);
@@ -10,28 +10,48 @@
  * 09-JUN-2024 implemented boot ROM
  * 28-JUN-2024 added second memory bank
  * 29-JUN-2024 implemented banked memory
+ * 16-OCT-2026 memory access through page tables
+ * 16-OCT-2026 configurable number of banks and common segment size
+ * 16-OCT-2026 count executed instructions
  */
 
 #include <stdlib.h>
 
 #include "sim.h"
 #include "simdefs.h"
+#include "simglb.h"
 #include "simmem.h"
 
 /* 64KB bank 0 + common segment */
 BYTE __aligned(4) bnk0[65536];
-/* 48KB bank 1 */
-BYTE __aligned(4) bnk1[49152];
+/* banks 1 - NUMBNK-1 with the size of the banked segment */
+static BYTE __aligned(4) bnkx[NUMBNK - 1][BNKSIZ];
+/* pointers to the banks */
+BYTE *banks[NUMBNK];
 /* selected bank */
 BYTE selbnk;
 
+/* page tables for memory reads and writes */
+BYTE *rd_page[256], *wr_page[256];
+/* page for the writes into the ROM */
+static BYTE rom_discard[256];
+
+#ifdef WANT_ICNT
+/* executed instructions */
+uint64_t icount;
+#endif
+
 /* boot ROM code */
 #define MEMSIZE 256
 #include "bootrom.c"
 
 void init_memory(void)
 {
-	register int i;
+	register int i, j;
+
+	banks[0] = bnk0;
+	for (i = 1; i < NUMBNK; i++)
+		banks[i] = bnkx[i - 1];
 
 	/* copy boot ROM into write protected top memory page */
 	for (i = 0; i < MEMSIZE; i++)
@@ -40,11 +60,42 @@ void init_memory(void)
 	/* trash memory like in a real machine after power on */
 	for (i = 0; i < 0xff00; i++)
 		bnk0[i] = rand() % 256;
-	for (i = 0; i < 0xc000; i++)
-		bnk1[i] = rand() % 256;
+	for (j = 0; j < NUMBNK - 1; j++)
+		for (i = 0; i < BNKSIZ; i++)
+			bnkx[j][i] = rand() % 256;
+
+	/* the common segment and the ROM are always mapped */
+	for (i = BNKSIZ >> 8; i < 0xff; i++)
+		rd_page[i] = wr_page[i] = &bnk0[i << 8];
+	rd_page[0xff] = &bnk0[0xff00];
+	wr_page[0xff] = rom_discard;
+
+	select_bank(0);
 }
 
 void reset_memory(void)
 {
-	selbnk = 0;
+	select_bank(0);
+}
+
+/*
+ * select memory bank 'bank' for the banked segment of the address
+ * space, selecting a bank that doesn't exist stops the CPU with an
+ * I/O error and leaves the current bank selected
+ */
+void select_bank(BYTE bank)
+{
+	register BYTE *p;
+	register int i;
+
+	if (bank >= NUMBNK) {
+		cpu_error = IOERROR;
+		cpu_state = ST_STOPPED;
+		return;
+	}
+
+	p = banks[bank];
+	selbnk = bank;
+	for (i = 0; i < (BNKSIZ >> 8); i++)
+		rd_page[i] = wr_page[i] = p + (i << 8);
 }
@@ -10,29 +10,67 @@
  * 23-APR-2024 derived from z80sim
  * 29-JUN-2024 implemented banked memory
  * 14-DEC-2024 added hardware breakpoint support
+ * 16-OCT-2026 memory access through page tables
+ * 16-OCT-2026 configurable number of banks and common segment size
+ * 16-OCT-2026 count executed instructions
+ * 16-OCT-2026 count executed opcodes
  */
 
 #ifndef SIMMEM_INC
 #define SIMMEM_INC
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "sim.h"
 #include "simdefs.h"
 #ifdef WANT_ICE
 #include "simice.h"
 #endif
+#ifdef WANT_OPSTAT
+#include "opstat.h"
+#endif
 
-#if defined(SIMPLEPANEL) || defined(BUS_8080)
+#if defined(SIMPLEPANEL) || defined(BUS_8080) || defined(WANT_ICNT)
 #include "simglb.h"
 #endif
 
-extern BYTE bnk0[65536], bnk1[49152];
+#if NUMBNK < 2 || BNKSIZ % 4096 != 0 || BNKSIZ < 4096 || BNKSIZ > 61440
+#error "invalid memory bank configuration"
+#endif
+
+extern BYTE bnk0[65536];
+extern BYTE *banks[NUMBNK];
 extern BYTE selbnk;
 
+/* pointers to the 256 byte pages of the memory for reads and writes */
+/* in the 64 KB address space, rebuilt when the bank is switched */
+extern BYTE *rd_page[256], *wr_page[256];
+
+#ifdef WANT_ICNT
+/* number of opcode fetches (M1 cycles) of the CPU, a prefixed */
+/* Z80 instruction counts once for each prefix like in the R register */
+extern uint64_t icount;
+#endif
+
 extern void init_memory(void), reset_memory(void);
+extern void select_bank(BYTE bank);
 
 /* Last page in memory is ROM and write protected. Some software */
 /* expects a ROM in upper memory, if not it will wrap arround to */
 /* address 0, and destroys itself with testing RAM access. */
+/* The write pointer of the ROM page points to a discard page. */
+
+/*
+ * get a pointer to 'addr' in memory bank 'bank',
+ * independent of the currently selected bank
+ */
+static inline BYTE *bank_addr(BYTE bank, WORD addr)
+{
+	if (addr >= BNKSIZ)
+		return &bnk0[addr];
+	return &banks[bank][addr];
+}
 
 /*
  * memory access for the CPU cores
@@ -53,12 +91,7 @@ static inline void memwrt(WORD addr, BYTE data)
 		hb_trig = HB_WRITE;
 #endif
 
-	if ((selbnk == 0) || (addr >= 0xc000)) {
-		if (addr < 0xff00)
-			bnk0[addr] = data;
-	} else {
-		bnk1[addr] = data;
-	}
+	wr_page[addr >> 8][addr & 0xff] = data;
 }
 
 static inline BYTE memrdr(WORD addr)
@@ -77,10 +110,15 @@ static inline BYTE memrdr(WORD addr)
 	}
 #endif
 
-	if ((selbnk == 0) || (addr >= 0xc000))
-		data = bnk0[addr];
-	else
-		data = bnk1[addr];
+	data = rd_page[addr >> 8][addr & 0xff];
+
+#ifdef WANT_ICNT
+	if (cpu_bus & CPU_M1)
+		icount++;
+#endif
+#ifdef WANT_OPSTAT
+	opstat_fetch(data);
+#endif
 
 #ifdef BUS_8080
 	cpu_bus &= ~CPU_M1;
@@ -100,20 +138,32 @@ static inline BYTE memrdr(WORD addr)
  */
 static inline void dma_write(WORD addr, BYTE data)
 {
-	if ((selbnk == 0) || (addr >= 0xc000)) {
-		if (addr < 0xff00)
-			bnk0[addr] = data;
-	} else {
-		bnk1[addr] = data;
-	}
+	wr_page[addr >> 8][addr & 0xff] = data;
 }
 
 static inline BYTE dma_read(WORD addr)
 {
-	if ((selbnk == 0) || (addr >= 0xc000))
-		return bnk0[addr];
-	else
-		return bnk1[addr];
+	return rd_page[addr >> 8][addr & 0xff];
+}
+
+/*
+ * get a pointer into the memory for a DMA transfer of 'len' bytes
+ * starting at 'addr', if the area lies completely within one bank
+ * and below the ROM page, so that it can be copied in one go,
+ * otherwise NULL and dma_read()/dma_write() must be used
+ */
+static inline BYTE *dma_ptr(WORD addr, unsigned int len)
+{
+	register unsigned int last = addr + len - 1;
+
+	if (last >= 0xff00)
+		return NULL;
+	/* bank 0 is 64 KB, the others only have the banked segment */
+	if (selbnk == 0 || addr >= BNKSIZ)
+		return &bnk0[addr];
+	if (last < BNKSIZ)
+		return &banks[selbnk][addr];
+	return NULL;
 }
 
 /*
@@ -121,20 +171,12 @@ static inline BYTE dma_read(WORD addr)
  */
 static inline void putmem(WORD addr, BYTE data)
 {
-	if ((selbnk == 0) || (addr >= 0xc000)) {
-		if (addr < 0xff00)
-			bnk0[addr] = data;
-	} else {
-		bnk1[addr] = data;
-	}
+	wr_page[addr >> 8][addr & 0xff] = data;
 }
 
 static inline BYTE getmem(WORD addr)
 {
-	if ((selbnk == 0) || (addr >= 0xc000))
-		return bnk0[addr];
-	else
-		return bnk1[addr];
+	return rd_page[addr >> 8][addr & 0xff];
 }
 
 #endif /* !SIMMEM_INC */
@@ -0,0 +1,438 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements the buffered serial I/O of the SIO.
+ *
+ * While the CPU runs, console input is moved into a receive buffer
+ * by the chars available callbacks of the stdio drivers. The UART
+ * driver calls its callback from the receive interrupt, which reads
+ * the UART FIFO directly. The USB driver calls its callback from the
+ * background task after the CDC interface received data, which reads
+ * the CDC FIFO without waiting for the USB stack. The status and data
+ * ports only look at the buffer and never call into the drivers.
+ *
+ * If the buffer is full, the input is left in the drivers: the UART
+ * keeps it in its FIFO with the receive interrupt off, and the USB CDC
+ * interface stops accepting data from the host, the background task
+ * signals it again later. With SIO_RTS_PIN, RTS is switched off before
+ * the buffer is full and on again when it is mostly empty.
+ *
+ * When the machine reads a command line for the ICE or at the end,
+ * console input goes directly to the stdio drivers again.
+ *
+ * Console output goes into a transmit buffer, which a repeating
+ * alarm drains in batches into the UART FIFO and the USB CDC FIFO,
+ * without waiting for either. Each of them has its own position in
+ * the buffer, the slower one limits the space. The UART never loses
+ * output, when the buffer is full the status port reports the
+ * transmitter busy until the UART took some of it. USB output, which
+ * the host doesn't take for SIO_TX_TIMEOUT_US, is discarded like with
+ * the stdio driver. Output from the stdio functions must wait until
+ * the buffer is empty, otherwise it gets mixed up.
+ *
+ * The second channel only runs over the second USB CDC interface.
+ * The same alarm moves its input from the CDC FIFO into a receive
+ * buffer and its output from a transmit buffer into the CDC FIFO.
+ * If a buffer is full, the data stays in the CDC FIFO or in the
+ * buffer, so that the USB flow control reaches from the host to the
+ * program on both ways.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 buffered output
+ * 16-OCT-2026 second channel on the second USB CDC interface
+ * 16-OCT-2026 read the UART and USB input without waiting in interrupts
+ * 16-OCT-2026 wait for space in the buffer of the second channel
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/binary_info.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+#include "hardware/uart.h"
+#if LIB_PICO_STDIO_UART
+#include "pico/stdio_uart.h"
+#endif
+#if LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO
+#include "stdio_msc_usb.h"
+#elif LIB_PICO_STDIO_USB
+#error "buffered output needs the USB stdio of the stdio_msc_usb library"
+#endif
+
+#include "sim.h"
+#include "simdefs.h"
+#include "simglb.h"
+
+#include "sio.h"
+
+static BYTE sio_rx_buf[SIO_RX_SIZE];
+sio_ring_t sio_rx = {			/* received console input */
+	.mask = SIO_RX_SIZE - 1,
+	.buf = sio_rx_buf
+};
+bool sio_rx_on;				/* console input into the buffer */
+static volatile bool sio_rx_held;	/* input left in the UART FIFO */
+#ifdef SIO_RTS_PIN
+static volatile bool sio_rx_rts;	/* RTS is on */
+#endif
+
+static BYTE sio_tx_buf[SIO_TX_SIZE];
+sio_ring_t sio_tx = {			/* console output */
+	.mask = SIO_TX_SIZE - 1,
+	.buf = sio_tx_buf
+};
+#if LIB_PICO_STDIO_UART
+static uint16_t sio_tx_uart;		/* next byte for the UART */
+#endif
+#if LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO
+static uint16_t sio_tx_usb;		/* next byte for USB */
+static uint64_t sio_tx_usb_stall;	/* USB takes no output since, or 0 */
+#endif
+
+#ifdef SIO2
+static BYTE sio2_rx_buf[SIO2_RX_SIZE];
+sio_ring_t sio2_rx = {			/* input of the second channel */
+	.mask = SIO2_RX_SIZE - 1,
+	.buf = sio2_rx_buf
+};
+static BYTE sio2_tx_buf[SIO2_TX_SIZE];
+sio_ring_t sio2_tx = {			/* output of the second channel */
+	.mask = SIO2_TX_SIZE - 1,
+	.buf = sio2_tx_buf
+};
+#endif
+
+/*
+ * input was put into the receive buffer
+ */
+static void sio_rx_filled(void)
+{
+#ifdef SIO_RTS_PIN
+	if (sio_rx_rts && sio_ring_count(&sio_rx) >= SIO_RX_STOP) {
+		gpio_put(SIO_RTS_PIN, 1);	/* RTS off, sender must stop */
+		sio_rx_rts = false;
+	}
+#endif
+	__sev();	/* wake up the CPU, if it waits for input */
+}
+
+#if LIB_PICO_STDIO_UART
+/*
+ * move the input of the UART FIFO into the receive buffer, the
+ * receive interrupt stays off while the buffer is full
+ */
+static void sio_rx_uart_fill(void)
+{
+	while (sio_ring_free(&sio_rx) > 0 && uart_is_readable(uart_default))
+		sio_ring_put(&sio_rx, (BYTE) uart_getc(uart_default));
+	sio_rx_held = sio_ring_free(&sio_rx) == 0;
+	/* the stdio driver turned it off before calling back */
+	if (!sio_rx_held)
+		uart_set_irqs_enabled(uart_default, true, false);
+	sio_rx_filled();
+}
+
+/*
+ * chars available callback of the UART driver,
+ * runs in the receive interrupt
+ */
+static void sio_rx_uart_cb(void *param)
+{
+	UNUSED(param);
+
+	sio_rx_uart_fill();
+}
+#endif
+
+#if LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO
+/*
+ * move the input of the CDC FIFO into the receive buffer, what
+ * doesn't fit stays there and is signalled again by the driver
+ */
+static void sio_rx_usb_fill(void)
+{
+	uint16_t pos;
+	int n;
+	uint32_t save;
+
+	/* the UART receive interrupt also puts input into the buffer */
+	save = save_and_disable_interrupts();
+	while ((n = sio_ring_free(&sio_rx)) > 0) {
+		/* up to the end of the buffer in one piece */
+		pos = sio_rx.head & sio_rx.mask;
+		if (n > (int) (sio_rx.mask + 1 - pos))
+			n = sio_rx.mask + 1 - pos;
+		n = stdio_msc_usb_in_chars_try((char *) sio_rx.buf + pos, n);
+		if (n == 0)
+			break;
+		__dmb();	/* the bytes must be there before head moves */
+		sio_rx.head += n;
+	}
+	sio_rx_filled();
+	restore_interrupts(save);
+}
+
+/*
+ * chars available callback of the USB driver,
+ * runs in the background task
+ */
+static void sio_rx_usb_cb(void *param)
+{
+	UNUSED(param);
+
+	sio_rx_usb_fill();
+}
+#endif
+
+/*
+ * move output from the transmit buffer into the FIFOs
+ * of the UART and USB and free what both have taken
+ */
+static void __not_in_flash_func(sio_tx_drain)(void)
+{
+	uint16_t head = sio_tx.head, tail = head;
+#if LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO
+	uint64_t now;
+	int n;
+#endif
+
+	__dmb();	/* read the bytes after head */
+
+#if LIB_PICO_STDIO_UART
+	while (sio_tx_uart != head && uart_is_writable(uart_default))
+		uart_putc_raw(uart_default,
+			      sio_tx.buf[sio_tx_uart++ & sio_tx.mask]);
+	tail = sio_tx_uart;
+#endif
+
+#if LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO
+	while (sio_tx_usb != head) {
+		/* up to the end of the buffer in one piece */
+		n = (uint16_t) (head - sio_tx_usb);
+		if (n > (int) (sio_tx.mask + 1 - (sio_tx_usb & sio_tx.mask)))
+			n = sio_tx.mask + 1 - (sio_tx_usb & sio_tx.mask);
+		n = stdio_msc_usb_out_chars_try((const char *) sio_tx.buf +
+						(sio_tx_usb & sio_tx.mask), n);
+		if (n == 0)
+			break;
+		sio_tx_usb += n;
+		sio_tx_usb_stall = 0;
+	}
+	if (sio_tx_usb != head) {
+		now = time_us_64();
+		if (sio_tx_usb_stall == 0)
+			sio_tx_usb_stall = now;
+		else if (now - sio_tx_usb_stall > SIO_TX_TIMEOUT_US) {
+			sio_tx_usb = head; /* host doesn't take it, discard */
+			sio_tx_usb_stall = 0;
+		}
+	}
+	/* free up to the output that is furthest behind */
+	if ((uint16_t) (head - sio_tx_usb) > (uint16_t) (head - tail))
+		tail = sio_tx_usb;
+#endif
+
+	__dmb();	/* the bytes are read before tail moves */
+	sio_tx.tail = tail;
+	__sev();	/* wake up the CPU, if it waits for space */
+}
+
+#ifdef SIO2
+/*
+ * move the input of the second CDC interface into the receive
+ * buffer and the transmit buffer into its FIFO, the buffers are
+ * filled and drained in pieces up to their end
+ */
+static void __not_in_flash_func(sio2_io)(void)
+{
+	uint16_t pos, head;
+	int n;
+	bool moved = false;
+
+	while ((n = sio_ring_free(&sio2_rx)) > 0) {
+		pos = sio2_rx.head & sio2_rx.mask;
+		if (n > (int) (sio2_rx.mask + 1 - pos))
+			n = sio2_rx.mask + 1 - pos;
+		n = stdio_msc_usb_aux_in_chars_try((char *) sio2_rx.buf + pos,
+						   n);
+		if (n == 0)
+			break;
+		__dmb();	/* the bytes must be there before head moves */
+		sio2_rx.head += n;
+		moved = true;
+	}
+
+	head = sio2_tx.head;
+	if (sio2_tx.tail != head) {
+		__dmb();	/* read the bytes after head */
+		while (sio2_tx.tail != head) {
+			pos = sio2_tx.tail & sio2_tx.mask;
+			n = (uint16_t) (head - sio2_tx.tail);
+			if (n > (int) (sio2_tx.mask + 1 - pos))
+				n = sio2_tx.mask + 1 - pos;
+			n = stdio_msc_usb_aux_out_chars_try(
+				(const char *) sio2_tx.buf + pos, n);
+			if (n == 0)
+				break;
+			__dmb();	/* the bytes are read before tail moves */
+			sio2_tx.tail += n;
+			moved = true;
+		}
+	}
+
+	if (moved)
+		__sev();	/* wake up the CPU, if it waits */
+}
+#endif
+
+/*
+ * alarm callback, does the buffered I/O with the drivers
+ */
+static int64_t __not_in_flash_func(sio_task)(alarm_id_t id, void *user_data)
+{
+	UNUSED(id);
+	UNUSED(user_data);
+
+	if (sio_tx.tail != sio_tx.head)
+		sio_tx_drain();
+#ifdef SIO2
+	sio2_io();
+#endif
+
+	return SIO_TX_US;
+}
+
+/*
+ * initialize the SIO
+ */
+void sio_init(void)
+{
+#ifdef SIO_RTS_PIN
+	bi_decl(bi_1pin_with_name(SIO_RTS_PIN, "UART RTS"));
+
+	gpio_init(SIO_RTS_PIN);
+	gpio_set_dir(SIO_RTS_PIN, GPIO_OUT);
+	gpio_put(SIO_RTS_PIN, 0);	/* RTS on */
+	sio_rx_rts = true;
+#endif
+
+	add_alarm_in_us(SIO_TX_US, sio_task, NULL, true);
+}
+
+/*
+ * console input into the receive buffer, called when the CPU
+ * accesses the SIO the first time after the start or the ICE
+ */
+void sio_rx_start(void)
+{
+	uint32_t save;
+
+#if LIB_PICO_STDIO_UART
+	stdio_uart.set_chars_available_callback(sio_rx_uart_cb, NULL);
+#endif
+#if LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO
+	stdio_msc_usb.set_chars_available_callback(sio_rx_usb_cb, NULL);
+#endif
+	sio_rx_on = true;
+
+	/* input received before isn't signalled again */
+	save = save_and_disable_interrupts();
+#if LIB_PICO_STDIO_UART
+	sio_rx_uart_fill();
+#endif
+#if LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO
+	sio_rx_usb_fill();
+#endif
+	restore_interrupts(save);
+}
+
+/*
+ * console input directly from the stdio drivers, the input left
+ * in the buffer stays there for the CPU
+ */
+void sio_rx_stop(void)
+{
+#if LIB_PICO_STDIO_UART
+	stdio_uart.set_chars_available_callback(NULL, NULL);
+#endif
+#if LIB_STDIO_MSC_USB && !STDIO_MSC_USB_DISABLE_STDIO
+	stdio_msc_usb.set_chars_available_callback(NULL, NULL);
+#endif
+	sio_rx_on = false;
+#ifdef SIO_RTS_PIN
+	gpio_put(SIO_RTS_PIN, 0);	/* RTS on */
+	sio_rx_rts = true;
+#endif
+}
+
+/*
+ * get the next byte from the receive buffer, which must not
+ * be empty, and let the sender continue, if it was stopped
+ */
+BYTE __not_in_flash_func(sio_rx_getc)(void)
+{
+	BYTE data;
+	uint32_t save;
+
+	data = sio_ring_get(&sio_rx);
+
+#ifdef SIO_RTS_PIN
+	if (sio_ring_count(&sio_rx) <= SIO_RX_START &&
+	    (sio_rx_held || !sio_rx_rts)) {
+#else
+	if (sio_ring_count(&sio_rx) <= SIO_RX_START && sio_rx_held) {
+#endif
+		save = save_and_disable_interrupts();
+#if LIB_PICO_STDIO_UART
+		/* the UART driver doesn't signal the held input again */
+		if (sio_rx_held)
+			sio_rx_uart_fill();
+#endif
+#ifdef SIO_RTS_PIN
+		if (!sio_rx_rts && sio_ring_count(&sio_rx) < SIO_RX_STOP) {
+			gpio_put(SIO_RTS_PIN, 0);	/* RTS on */
+			sio_rx_rts = true;
+		}
+#endif
+		restore_interrupts(save);
+	}
+
+	return data;
+}
+
+/*
+ * wait for space in the transmit buffer
+ */
+void __not_in_flash_func(sio_tx_wait)(void)
+{
+	while (!sio_tx_ready())
+		__wfe();
+}
+
+#ifdef SIO2
+/*
+ * wait for space in the transmit buffer of the second channel,
+ * when the host closes the CDC interface the buffer is discarded,
+ * a break on the console stops waiting
+ */
+void __not_in_flash_func(sio2_tx_wait)(void)
+{
+	while (!sio2_tx_ready() && cpu_state != ST_STOPPED)
+		__wfe();
+}
+#endif
+
+/*
+ * wait until the transmit buffer is empty, before
+ * output with the stdio functions
+ */
+void sio_tx_flush(void)
+{
+	while (sio_ring_count(&sio_tx) != 0)
+		__wfe();
+}
@@ -0,0 +1,145 @@
+/*
+ * Z80SIM  -  a Z80-CPU simulator
+ *
+ * Copyright (C) 2024 by Udo Munk & Thomas Eberhardt
+ *
+ * This module implements the buffered serial I/O of the SIO.
+ *
+ * History:
+ * 16-OCT-2026 first implementation
+ * 16-OCT-2026 buffered output
+ * 16-OCT-2026 second channel on the second USB CDC interface
+ * 16-OCT-2026 wait for space in the buffer of the second channel
+ */
+
+#ifndef SIO_INC
+#define SIO_INC
+
+#include <stdint.h>
+#include "hardware/sync.h"
+
+#include "sim.h"
+#include "simdefs.h"
+
+#define SIO_RX_SIZE	256	/* size of the receive buffer, power of 2 */
+#define SIO_RX_STOP	(SIO_RX_SIZE - 64) /* RTS off at this many bytes */
+#define SIO_RX_START	(SIO_RX_SIZE / 4) /* RTS on again at this many */
+/*#define SIO_RTS_PIN	2*/	/* GPIO for RTS flow control, active low */
+#define SIO_TX_SIZE	512	/* size of the transmit buffer, power of 2 */
+#define SIO_TX_US	1000	/* interval of the buffered I/O task */
+#define SIO_TX_TIMEOUT_US 500000 /* discard USB output not taken for this */
+
+#if LIB_STDIO_MSC_USB && STDIO_MSC_USB_AUX_CDC
+#define SIO2			/* second channel on the second CDC interface */
+#define SIO2_RX_SIZE	512	/* size of its receive buffer, power of 2 */
+#define SIO2_TX_SIZE	512	/* size of its transmit buffer, power of 2 */
+#endif
+
+/*
+ * ring buffer between an interrupt handler and the CPU, the
+ * producer only changes head and the consumer only changes tail
+ */
+typedef struct sio_ring {
+	volatile uint16_t head;	/* next byte to put */
+	volatile uint16_t tail;	/* next byte to get */
+	uint16_t mask;		/* size - 1, size is a power of 2 */
+	BYTE *buf;
+} sio_ring_t;
+
+static inline unsigned int sio_ring_count(const sio_ring_t *r)
+{
+	return (uint16_t) (r->head - r->tail);
+}
+
+static inline unsigned int sio_ring_free(const sio_ring_t *r)
+{
+	return r->mask + 1 - sio_ring_count(r);
+}
+
+static inline void sio_ring_put(sio_ring_t *r, BYTE data)
+{
+	r->buf[r->head & r->mask] = data;
+	__dmb();	/* the byte must be there before head moves */
+	r->head++;
+}
+
+static inline BYTE sio_ring_get(sio_ring_t *r)
+{
+	BYTE data = r->buf[r->tail & r->mask];
+
+	__dmb();	/* the byte must be read before tail moves */
+	r->tail++;
+	return data;
+}
+
+extern sio_ring_t sio_rx, sio_tx;
+extern bool sio_rx_on;
+
+extern void sio_init(void);
+extern void sio_rx_start(void);
+extern void sio_rx_stop(void);
+extern BYTE sio_rx_getc(void);
+extern void sio_tx_wait(void);
+extern void sio_tx_flush(void);
+#ifdef SIO2
+extern sio_ring_t sio2_rx, sio2_tx;
+extern void sio2_tx_wait(void);
+#endif
+
+/*
+ * check if there is received input in the buffer
+ */
+static inline bool sio_rx_avail(void)
+{
+	return sio_ring_count(&sio_rx) != 0;
+}
+
+/*
+ * check if there is space in the transmit buffer
+ */
+static inline bool sio_tx_ready(void)
+{
+	return sio_ring_free(&sio_tx) != 0;
+}
+
+/*
+ * put a byte into the transmit buffer, waits if it is full
+ */
+static inline void sio_tx_putc(BYTE data)
+{
+	if (!sio_tx_ready())
+		sio_tx_wait();
+	sio_ring_put(&sio_tx, data);
+}
+
+#ifdef SIO2
+/*
+ * check if there is received input in the buffer of the second channel
+ */
+static inline bool sio2_rx_avail(void)
+{
+	return sio_ring_count(&sio2_rx) != 0;
+}
+
+/*
+ * check if there is space in the transmit buffer of the second channel
+ */
+static inline bool sio2_tx_ready(void)
+{
+	return sio_ring_free(&sio2_tx) != 0;
+}
+
+/*
+ * put a byte into the transmit buffer of the second channel,
+ * waits if it is full, only a break on the console drops it
+ */
+static inline void sio2_tx_putc(BYTE data)
+{
+	if (!sio2_tx_ready())
+		sio2_tx_wait();
+	if (sio2_tx_ready())
+		sio_ring_put(&sio2_tx, data);
+}
+#endif
+
+#endif /* !SIO_INC */